@@ -0,0 +1,32 @@
+#pragma once
+/************************************************************************************
+ * Simulated Teensy 4.1 core for host (Linux) builds. See README.md
+ ************************************************************************************/
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#define TEENSYDUINO 159
+#define ARDUINO_TEENSY_SIM
+
+#define FASTRUN
+#define DMAMEM
+#define EXTMEM
+#define FLASHMEM
+#define PROGMEM
+#define F(x) (x)
+
+#include "imxrt.h"
+#include "core_pins.h"
+#include "usb_serial.h"
+#include "IntervalTimer.h"
+
+template <class A, class B>
+constexpr auto min(A a, B b) -> decltype(a < b ? a : b) { return a < b ? a : b; }
+template <class A, class B>
+constexpr auto max(A a, B b) -> decltype(a > b ? a : b) { return a > b ? a : b; }
@@ -0,0 +1,100 @@
+#pragma once
+/************************************************************************************
+ * Minimal DMAChannel for memory -> register transfers.
+ * Continuously triggered transfers are done immediately when the channel is enabled.
+ * Transfers triggered by a PIT channel (routed through XBAR1 output DMA_CH_MUX_REQ30)
+ * move one element per PIT period (LDVAL + 1 ticks of 24MHz), the elements which are
+ * due are moved when complete() is polled. Each poll takes one cycle.
+ ************************************************************************************/
+
+#include "imxrt.h"
+#include <cstdint>
+
+class DMAChannel
+{
+ public:
+    void begin(bool = false) { done = false; trigger = -1; }
+    void release() {}
+
+    template <typename T>
+    void sourceBuffer(const volatile T p[], unsigned int len)
+    {
+        source     = (const volatile uint8_t*)p;
+        sourceSize = sizeof(T);
+        count      = len / sizeof(T);
+    }
+
+    template <typename T>
+    void destination(volatile T& p)
+    {
+        dest     = (volatile uint8_t*)&p;
+        destSize = sizeof(T);
+    }
+
+    void transferCount(unsigned int len) { count = len; }
+    void disableOnCompletion() {}
+    void triggerContinuously() { trigger = -1; }
+    void triggerAtHardwareEvent(uint8_t source) { trigger = source; }
+    void interruptAtCompletion() {}
+
+    void enable()
+    {
+        moved  = 0;
+        start  = sim::cycles();
+        period = 0;
+        if (trigger < 0) move(count);
+    }
+    void disable() {}
+
+    bool complete()
+    {
+        if (!done && moved < count)
+        {
+            if (period == 0) period = pitPeriod(); // the PIT is usually started after the channel
+            if (period == 0)
+            {
+                move(count); // not routed to a running PIT
+                return done;
+            }
+            sim::advance(1);
+            uint64_t due = (sim::cycles() - start) / period;
+            move(due < count ? (unsigned)due : count);
+        }
+        return done;
+    }
+    void clearComplete() { done = false; }
+
+ private:
+    void move(unsigned upTo)
+    {
+        for (; moved < upTo; moved++)
+        {
+            uint32_t value = 0;
+            for (unsigned b = 0; b < sourceSize && b < 4; b++) value |= (uint32_t)source[moved * sourceSize + b] << (8 * b);
+            for (unsigned b = 0; b < destSize && b < 4; b++) dest[b] = value >> (8 * b);
+            sim::sync();
+        }
+        done = moved == count;
+    }
+
+    uint64_t pitPeriod() const // CPU cycles between two triggers, 0: no running PIT routed to the channel
+    {
+        if (trigger != DMAMUX_SOURCE_XBAR1_0 || !(XBARA1_CTRL0 & XBARA_CTRL_DEN0)) return 0;
+        volatile uint16_t* sel = &XBARA1_SEL0 + XBARA1_OUT_DMA_CH_MUX_REQ30 / 2;
+        unsigned input         = (XBARA1_OUT_DMA_CH_MUX_REQ30 & 1) ? *sel >> 8 : *sel & 0xFF;
+        if (input < XBARA1_IN_PIT_TRIGGER0 || input > XBARA1_IN_PIT_TRIGGER3) return 0;
+        const IMXRT_PIT_CHANNEL_t& pit = IMXRT_PIT_CHANNELS[input - XBARA1_IN_PIT_TRIGGER0];
+        if (!(pit.TCTRL & PIT_TCTRL_TEN)) return 0;
+        return (pit.LDVAL + 1ull) * (F_CPU / 24'000'000);
+    }
+
+ protected:
+    const volatile uint8_t* source = nullptr;
+    volatile uint8_t* dest         = nullptr;
+    unsigned sourceSize = 1, destSize = 1, count = 0;
+    bool done = false;
+    int trigger     = -1;
+    unsigned moved  = 0;
+    uint64_t start  = 0;
+    uint64_t period = 0;
+};
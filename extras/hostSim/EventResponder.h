@@ -0,0 +1,51 @@
+#pragma once
+/************************************************************************************
+ * Subset of the EventResponder of the Teensy core (yield mode only)
+ ************************************************************************************/
+
+#include <cstddef>
+
+class EventResponder;
+typedef EventResponder& EventResponderRef;
+typedef void (*EventResponderFunction)(EventResponderRef);
+
+class EventResponder
+{
+ public:
+    constexpr EventResponder() {}
+    ~EventResponder() { detach(); }
+
+    void attach(EventResponderFunction function, unsigned char /*priority*/ = 128)
+    {
+        detach();
+        _function = function;
+    }
+
+    void detach()
+    {
+        clearEvent();
+        _function = nullptr;
+    }
+
+    void triggerEvent(int status = 0, void* data = nullptr);
+    void clearEvent();
+
+    int getStatus() { return _status; }
+    void* getData() { return _data; }
+    void setContext(void* context) { _context = context; }
+    void* getContext() { return _context; }
+
+    static void runFromYield();
+
+ protected:
+    EventResponderFunction _function = nullptr;
+    int _status                      = 0;
+    void* _data                      = nullptr;
+    void* _context                   = nullptr;
+    bool _triggered                  = false;
+    EventResponder* _next            = nullptr;
+
+    static EventResponder* firstYield;
+    static EventResponder* lastYield;
+    static bool runningFromYield;
+};
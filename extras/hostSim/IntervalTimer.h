@@ -0,0 +1,50 @@
+#pragma once
+/************************************************************************************
+ * Simulated IntervalTimer, 4 PIT channels sharing IRQ_PIT like the original
+ ************************************************************************************/
+
+#include "imxrt.h"
+#include <cstdint>
+
+class IntervalTimer
+{
+ public:
+    constexpr IntervalTimer() {}
+    ~IntervalTimer() { end(); }
+
+    bool begin(void (*funct)(), unsigned int microseconds) { return beginCycles(funct, (uint64_t)microseconds * (F_CPU / 1'000'000)); }
+    bool begin(void (*funct)(), int microseconds) { return microseconds < 0 ? false : begin(funct, (unsigned)microseconds); }
+    bool begin(void (*funct)(), unsigned long microseconds) { return begin(funct, (unsigned)microseconds); }
+    bool begin(void (*funct)(), long microseconds) { return begin(funct, (int)microseconds); }
+    bool begin(void (*funct)(), float microseconds) { return begin(funct, (double)microseconds); }
+    bool begin(void (*funct)(), double microseconds) { return microseconds <= 0 ? false : beginCycles(funct, (uint64_t)(microseconds * (F_CPU / 1'000'000) + 0.5)); }
+
+    void update(unsigned int microseconds)
+    {
+        if (channel >= 0) beginCycles(funct, (uint64_t)microseconds * (F_CPU / 1'000'000));
+    }
+
+    void end()
+    {
+        if (channel < 0) return;
+        sim::timerStop(channel);
+        channel = -1;
+    }
+
+    void priority(uint8_t n) { nvic_priority = n; }
+    operator IRQ_NUMBER_t() { return IRQ_PIT; }
+
+ private:
+    bool beginCycles(void (*f)(), uint64_t cycles)
+    {
+        end();
+        if (cycles < 17 || cycles > UINT32_MAX * 4ull) return false; // same limits as the 24MHz PIT
+        funct   = f;
+        channel = sim::timerStart(f, cycles);
+        return channel >= 0;
+    }
+
+    int channel           = -1;
+    void (*funct)()       = nullptr;
+    uint8_t nvic_priority = 128;
+};
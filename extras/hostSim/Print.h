@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print
+{
+ public:
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size)
+    {
+        for (size_t i = 0; i < size; i++) write(buffer[i]);
+        return size;
+    }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(long n, int base = DEC) { return base == DEC ? format("%ld", n) : print((unsigned long)n, base); }
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long long n) { return format("%lld", n); }
+    size_t print(unsigned long long n) { return format("%llu", n); }
+    size_t print(double n, int digits = 2) { return format("%.*f", digits, n); }
+
+    size_t println() { return write((uint8_t)'\n'); }
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(T value, int format) { return print(value, format) + println(); }
+
+    int printf(const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        int n = vprintf(format, args);
+        va_end(args);
+        return n;
+    }
+
+ protected:
+    size_t format(const char* fmt, ...)
+    {
+        va_list args;
+        va_start(args, fmt);
+        int n = vprintf(fmt, args);
+        va_end(args);
+        return n < 0 ? 0 : n;
+    }
+
+    int vprintf(const char* format, va_list args)
+    {
+        char buf[256];
+        int n = vsnprintf(buf, sizeof(buf), format, args);
+        if (n < 0) return n;
+        write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? n : sizeof(buf) - 1);
+        return n;
+    }
+};
+
+inline size_t Print::print(unsigned long n, int base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char* p = buf + sizeof(buf);
+    *--p    = '\0';
+    if (base < 2) base = 10;
+    do {
+        unsigned digit = n % base;
+        *--p           = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        n /= base;
+    } while (n);
+    return write(p);
+}
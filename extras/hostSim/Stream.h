@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Print.h"
+
+class Stream : public Print
+{
+ public:
+    virtual int available() = 0;
+    virtual int read()      = 0;
+    virtual int peek()      = 0;
+};
@@ -0,0 +1,47 @@
+#pragma once
+/************************************************************************************
+ * Simulated TimerOne library, the timer isr is driven by an IntervalTimer. Like the
+ * original, the isr calls the attached function through TimerOne::isrCallback
+ ************************************************************************************/
+
+#include "IntervalTimer.h"
+
+class TimerOne
+{
+ public:
+    void initialize(unsigned long microseconds = 1'000'000) { period = microseconds; }
+
+    void setPeriod(unsigned long microseconds)
+    {
+        period = microseconds;
+        if (running) timer.begin(isr, period);
+    }
+
+    void attachInterrupt(void (*callback)())
+    {
+        isrCallback = callback;
+        running     = timer.begin(isr, period);
+    }
+    void attachInterrupt(void (*callback)(), unsigned long microseconds)
+    {
+        period = microseconds;
+        attachInterrupt(callback);
+    }
+    void detachInterrupt() { stop(); }
+    void stop()
+    {
+        timer.end();
+        running = false;
+    }
+
+    static void isr() { isrCallback(); }
+    static void isrDefaultUnused() {}
+    static inline void (*isrCallback)() = isrDefaultUnused;
+
+ protected:
+    IntervalTimer timer;
+    unsigned long period = 1'000'000;
+    bool running         = false;
+};
+
+inline TimerOne Timer1;
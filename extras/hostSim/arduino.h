@@ -0,0 +1,2 @@
+#pragma once
+#include "Arduino.h" // some sources include the lower case name
@@ -0,0 +1,69 @@
+// Write throughput of the MicroMod BUS (G0..G7)
+
+#include "Arduino.h"
+#include "benchmark.h"
+
+#if defined(ARDUINO_TEENSY_MICROMOD)
+    #include "BusCapture.h"
+    #include "MicroModT4.h"
+
+namespace
+{
+    uint8_t data[4096];
+}
+
+BENCHMARK(busSingle, "bus.operator=", "MB/s")
+{
+    sim::reset();
+    MMT::mmBus.pinMode(OUTPUT);
+    uint8_t v = 0;
+    double ns = bench::nsPerCall([&] { MMT::mmBus = v++; });
+    return 1E3 / ns;
+}
+
+BENCHMARK(busBlock, "bus.write", "MB/s")
+{
+    sim::reset();
+    MMT::mmBus.pinMode(OUTPUT);
+    for (unsigned i = 0; i < sizeof(data); i++) data[i] = i * 7;
+    double ns = bench::nsPerCall([] { MMT::mmBus.write(data, sizeof(data)); }, 100);
+    return sizeof(data) * 1E3 / ns;
+}
+
+BENCHMARK(busDMA, "bus.writeDMA", "MB/s") // buffer preparation, pin hand over and the (simulated) transfer, host time
+{
+    static uint32_t buffer[sizeof(data)];
+    sim::reset();
+    MMT::mmBus.pinMode(OUTPUT);
+    double ns = bench::nsPerCall([] {
+        MMT::mmBus.writeDMA(data, sizeof(data), buffer, 6'000'000);
+        sim::advance(sizeof(data) * (F_CPU / 6'000'000));
+        while (MMT::mmBus.dmaBusy()) {}
+    }, 100);
+    return sizeof(data) * 1E3 / ns;
+}
+
+BENCHMARK(busDMARate, "bus.writeDMA.rate", "MB/s") // PIT paced byte rate in simulated time, requested: 3MB/s
+{
+    static uint32_t buffer[sizeof(data)];
+    sim::reset();
+    MMT::mmBus.pinMode(OUTPUT);
+    uint64_t start = sim::cycles();
+    MMT::mmBus.writeDMA(data, sizeof(data), buffer, 3'000'000);
+    while (MMT::mmBus.dmaBusy()) {}
+    return sizeof(data) * (F_CPU / 1E6) / (sim::cycles() - start);
+}
+
+// BusCapture, highest sample rate without overruns in simulated time (each cycle counter read costs 1 cycle)
+BENCHMARK(captureRaw, "busCapture.maxRate.raw", "MHz")
+{
+    sim::reset();
+    return MMT::BusCapture::maxSampleRate(false) / 1E6;
+}
+
+BENCHMARK(captureRle, "busCapture.maxRate.rle", "MHz")
+{
+    sim::reset();
+    return MMT::BusCapture::maxSampleRate(true) / 1E6;
+}
+#endif
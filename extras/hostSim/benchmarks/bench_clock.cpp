@@ -0,0 +1,34 @@
+// Cost of reading the clocks
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "teensy_clock.h"
+
+BENCHMARK(cyccnt, "clock.ARM_DWT_CYCCNT", "ns/read")
+{
+    sim::reset();
+    return bench::nsPerCall([] { bench::doNotOptimize(ARM_DWT_CYCCNT); });
+}
+
+BENCHMARK(cycles64, "clock.cycles64::get", "ns/read")
+{
+    sim::reset();
+    cycles64::begin();
+    return bench::nsPerCall([] { bench::doNotOptimize(cycles64::get()); });
+}
+
+BENCHMARK(teensyClock, "clock.teensy_clock::now", "ns/read")
+{
+    sim::reset();
+    teensy_clock::begin(false);
+    return bench::nsPerCall([] { bench::doNotOptimize(teensy_clock::now()); });
+}
+
+BENCHMARK(toMicros, "clock.toMicros", "ns/call")
+{
+    teensy_clock::duration d(123'456'789);
+    return bench::nsPerCall([&] {
+        bench::doNotOptimize(d);
+        bench::doNotOptimize(teensy_clock::toMicros(d));
+    });
+}
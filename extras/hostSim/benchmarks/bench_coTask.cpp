@@ -0,0 +1,116 @@
+// CoTask vs. a state machine polling millis(): switch cost and wake up error of a 1ms wait
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "coTask.h"
+#include <random>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    volatile uint32_t counter;
+    bool done;
+
+    CoTask::Task spinner(unsigned n)
+    {
+        while (n--)
+        {
+            counter = counter + 1;
+            co_await CoTask::next_yield();
+        }
+        done = true;
+    }
+
+    // the loop takes 5..15µs per iteration, a new 1ms wait starts at irregular times
+    constexpr unsigned nrOfWaits = 1000;
+    std::mt19937 rng;
+
+    void loopIteration(void (*poll)())
+    {
+        sim::advance(F_CPU / 1'000'000 * (5 + rng() % 11));
+        poll();
+    }
+
+    double errorSum;
+    unsigned waits;
+
+    CoTask::Task waiter()
+    {
+        for (unsigned i = 0; i < nrOfWaits; i++)
+        {
+            auto deadline = teensy_clock::now() + 1ms;
+            co_await CoTask::sleep_until(deadline);
+            errorSum += std::chrono::duration<double, std::micro>(teensy_clock::now() - deadline).count();
+            waits++;
+            co_await CoTask::sleep_for(std::chrono::microseconds(rng() % 500));
+        }
+        done = true;
+    }
+
+    // same with millis(): wait until millis() advanced by one, then idle for a random time
+    enum { waiting, idle } state = idle;
+    uint32_t startMs;
+    uint64_t startCycles, idleUntil;
+
+    void pollMillis()
+    {
+        if (state == waiting && millis() - startMs >= 1)
+        {
+            double actual = (double)(sim::cycles() - startCycles) / (F_CPU / 1'000'000);
+            errorSum += actual > 1000 ? actual - 1000 : 1000 - actual; // early or late
+            waits++;
+            state     = idle;
+            idleUntil = sim::cycles() + (uint64_t)(rng() % 500) * (F_CPU / 1'000'000);
+        }
+        else if (state == idle && sim::cycles() >= idleUntil)
+        {
+            startMs     = millis();
+            startCycles = sim::cycles();
+            state       = waiting;
+        }
+    }
+}
+
+BENCHMARK(coSwitch, "coTask.switch", "ns")
+{
+    sim::reset();
+    cycles64::begin();
+    done = false;
+    CoTask::start(spinner(7 * 100'000 + 1));
+    double ns = bench::nsPerCall(CoTask::run);
+    while (!done) CoTask::run();
+    return ns;
+}
+
+BENCHMARK(coPollMillis, "coTask.pollMillis", "ns")
+{
+    sim::reset();
+    return bench::nsPerCall([] {
+        static uint32_t last;
+        if (millis() - last >= 1) last = millis();
+        counter = counter + 1;
+    });
+}
+
+BENCHMARK(coWakeError, "coTask.wakeError.sleep", "us")
+{
+    sim::reset();
+    cycles64::begin();
+    rng.seed(1);
+    errorSum = waits = 0;
+    done     = false;
+    CoTask::start(waiter());
+    while (!done) loopIteration(CoTask::run);
+    return errorSum / waits;
+}
+
+BENCHMARK(coWakeErrorMillis, "coTask.wakeError.millis", "us")
+{
+    sim::reset();
+    rng.seed(1);
+    errorSum = waits = 0;
+    state    = idle;
+    while (waits < nrOfWaits) loopIteration(pollMillis);
+    return errorSum / waits;
+}
@@ -0,0 +1,49 @@
+// cycles64::get(): LDREX/STREX variant (library default) vs. the original variant which
+// disables interrupts. The second variant is compiled from the same source into its own
+// namespace. '.irq' figures: a 5µs IntervalTimer reads the counter as well.
+
+#include "Arduino.h"
+#include "IntervalTimer.h"
+#include "benchmark.h"
+#include "cycles64.h"
+
+#define CYCLES64_USE_NOINTERRUPTS
+#define cycles64 cycles64_noInterrupts
+#include "../../../src/teensy_clock/cycle64.cpp"
+#undef cycles64
+
+namespace
+{
+    template <uint64_t (*get)()>
+    double withIsr()
+    {
+        sim::reset();
+        IntervalTimer timer;
+        timer.begin([] { bench::doNotOptimize(get()); }, 5);
+        double ns = bench::nsPerCall([] { bench::doNotOptimize(get()); });
+        timer.end();
+        return ns;
+    }
+}
+
+BENCHMARK(c64Exclusive, "cycles64.ldrex", "ns/read")
+{
+    sim::reset();
+    return bench::nsPerCall([] { bench::doNotOptimize(cycles64::get()); });
+}
+
+BENCHMARK(c64NoInterrupts, "cycles64.noInterrupts", "ns/read")
+{
+    sim::reset();
+    return bench::nsPerCall([] { bench::doNotOptimize(cycles64_noInterrupts::get()); });
+}
+
+BENCHMARK(c64ExclusiveIsr, "cycles64.ldrex.irq", "ns/read")
+{
+    return withIsr<cycles64::get>();
+}
+
+BENCHMARK(c64NoInterruptsIsr, "cycles64.noInterrupts.irq", "ns/read")
+{
+    return withIsr<cycles64_noInterrupts::get>();
+}
@@ -0,0 +1,50 @@
+// teensy_disciplined_clock with an injected crystal error of the CPU clock:
+// time to lock within 1µs after a (re)start, residual frequency error and read cost
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "teensy_disciplined_clock.h"
+
+using clk = teensy_disciplined_clock;
+
+namespace
+{
+    constexpr double crystalError = 50; // ppm, typical for a cheap crystal over temperature
+
+    void start()
+    {
+        static bool started = false;
+        sim::reset();
+        sim::setCrystalError(crystalError);
+        rtc_set(1'000'000);
+        if (!started) clk::begin();
+        started = true;
+        sim::advance(10ull * F_CPU); // the RTC jumps for the clock -> restarts the discipline loop
+    }
+}
+
+BENCHMARK(dcSettle, "disciplinedClock.settle", "s")
+{
+    start();
+    rtc_set(rtc_get() + 100); // restart the loop
+    unsigned seconds = 0;
+    while (seconds < 600 && !(clk::isLocked() && std::abs(clk::phaseError()) < (int32_t)(F_CPU / 1'000'000)))
+    {
+        sim::advance(F_CPU);
+        seconds++;
+    }
+    return seconds;
+}
+
+BENCHMARK(dcFreqError, "disciplinedClock.freqError", "ppb")
+{
+    start();
+    sim::advance(60ull * F_CPU);
+    return std::abs(clk::frequencyError() - crystalError * 1000);
+}
+
+BENCHMARK(dcNow, "disciplinedClock.now", "ns/read")
+{
+    start();
+    return bench::nsPerCall([] { bench::doNotOptimize(clk::now()); });
+}
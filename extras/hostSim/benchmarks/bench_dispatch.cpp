@@ -0,0 +1,89 @@
+// Pin interrupt dispatch: worst case time from the pin edges to the return of the callbacks
+// with 1, 8 and 32 pins triggering at the same time (one isr entry for all edges), in host
+// cycles per edge. The cost of the simulated edges themselves (sim::setPin without attached
+// interrupt) is subtracted.
+
+#include "Arduino.h"
+#include "attachInterruptEx.h"
+#include "benchmark.h"
+
+#if defined(USE_PORT_DISPATCHER)
+    #define DISPATCH_NAME "dispatch.portDispatcher"
+#else
+    #define DISPATCH_NAME "dispatch.attachInterruptEx"
+#endif
+
+namespace
+{
+    volatile unsigned edges;
+
+    void onEdge() { edges = edges + 1; }
+
+    constexpr unsigned maxPins = 32; // pins 0..31, spread over all four fast GPIO ports
+
+    double maxCyclesPerEdge(unsigned nrOfPins)
+    {
+        bool level = false;
+        return bench::maxCyclesPerCall([&] {
+            level = !level;
+            noInterrupts();
+            for (unsigned p = 0; p < nrOfPins; p++) sim::setPin(p, level);
+            interrupts();
+        }, 2000 / nrOfPins) / nrOfPins;
+    }
+
+    double baseline(unsigned nrOfPins)
+    {
+        sim::reset();
+        for (unsigned p = 0; p < nrOfPins; p++) pinMode(p, INPUT);
+        return maxCyclesPerEdge(nrOfPins);
+    }
+
+    double core(unsigned nrOfPins)
+    {
+        double base = baseline(nrOfPins);
+        for (unsigned p = 0; p < nrOfPins; p++) attachInterrupt(p, onEdge, CHANGE);
+        double cycles = maxCyclesPerEdge(nrOfPins);
+        for (unsigned p = 0; p < nrOfPins; p++) detachInterrupt(p);
+        return cycles > base ? cycles - base : 0;
+    }
+
+    double ex(unsigned nrOfPins)
+    {
+        double base = baseline(nrOfPins);
+        for (unsigned p = 0; p < nrOfPins; p++) attachInterruptEx(p, [] { edges = edges + 1; }, CHANGE);
+        double cycles = maxCyclesPerEdge(nrOfPins);
+        for (unsigned p = 0; p < nrOfPins; p++) attachInterruptEx(p, nullptr, CHANGE);
+        return cycles > base ? cycles - base : 0;
+    }
+}
+
+BENCHMARK(dispatchCore1, "dispatch.core.1pin", "cycles")
+{
+    return core(1);
+}
+
+BENCHMARK(dispatchCore8, "dispatch.core.8pins", "cycles")
+{
+    return core(8);
+}
+
+BENCHMARK(dispatchCore32, "dispatch.core.32pins", "cycles")
+{
+    return core(maxPins);
+}
+
+BENCHMARK(dispatchEx1, DISPATCH_NAME ".1pin", "cycles")
+{
+    return ex(1);
+}
+
+BENCHMARK(dispatchEx8, DISPATCH_NAME ".8pins", "cycles")
+{
+    return ex(8);
+}
+
+BENCHMARK(dispatchEx32, DISPATCH_NAME ".32pins", "cycles")
+{
+    return ex(maxPins);
+}
@@ -0,0 +1,70 @@
+// EventTrace: cost of recording an event, encoded bytes per event and the sustained rate
+// when the buffer is drained to a stream (null stream, i.e. the recorder is the limit)
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "eventTrace.h"
+
+namespace
+{
+    struct NullStream : Stream
+    {
+        size_t bytes = 0;
+
+        size_t write(uint8_t) override { return write(nullptr, 1); }
+        size_t write(const uint8_t*, size_t n) override
+        {
+            bytes += n;
+            return n;
+        }
+        int availableForWrite() override { return 4096; }
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+    };
+
+    NullStream sink;
+
+    void loopEvents(unsigned n) // begin/end pairs of a few ids, the drain keeps up
+    {
+        for (unsigned i = 0; i < n; i++)
+        {
+            TRACE_BEGIN(i & 7);
+            TRACE_END(i & 7);
+            if ((i & 127) == 0) EventTrace::drain();
+        }
+        EventTrace::drain();
+    }
+}
+
+BENCHMARK(eventTraceRecord, "eventTrace.record", "ns")
+{
+    EventTrace::begin(sink, false);
+    double ns = bench::nsPerCall([] {
+        for (int i = 0; i < 128; i++) TRACE_INSTANT(1);
+        EventTrace::drain();
+    }, 1000);
+    EventTrace::end();
+    return ns / 128; // per event, the drain is amortized
+}
+
+BENCHMARK(eventTraceBytes, "eventTrace.bytesPerEvent", "bytes")
+{
+    EventTrace::begin(sink, false);
+    size_t bytes    = sink.bytes;
+    uint32_t events = EventTrace::getStats().events;
+    loopEvents(10'000);
+    EventTrace::end();
+    return (double)(sink.bytes - bytes) / (EventTrace::getStats().events - events);
+}
+
+BENCHMARK(eventTraceRate, "eventTrace.sustainedRate", "Mevent/s")
+{
+    constexpr unsigned n = 100'000;
+    EventTrace::begin(sink, false);
+    uint32_t dropped = EventTrace::getStats().dropped;
+    double ns        = bench::nsPerCall([] { loopEvents(n); }, 1);
+    EventTrace::end();
+    if (EventTrace::getStats().dropped != dropped) return 0; // not sustained
+    return 2 * n / ns * 1E3;
+}
@@ -0,0 +1,32 @@
+// fast_duration_cast vs. std::chrono::duration_cast for teensy_clock durations.
+// On the host the 64bit division is a single instruction, on the M7 it is a library call,
+// i.e. the host figures show the overhead of the reciprocal, not the gain on the board.
+
+#include "benchmark.h"
+#include "fast_duration_cast.h"
+#include "teensy_clock.h"
+
+namespace
+{
+    using us = std::chrono::duration<uint64_t, std::micro>;
+    using ns = std::chrono::duration<uint64_t, std::nano>;
+
+    template <class To, bool fast>
+    double perCast()
+    {
+        uint64_t c = 0x1234'5678'9ABC;
+        return bench::nsPerCall([&] {
+            bench::doNotOptimize(c);
+            teensy_clock::duration d(c++);
+            if constexpr (fast)
+                bench::doNotOptimize(fast_duration_cast<To>(d));
+            else
+                bench::doNotOptimize(std::chrono::duration_cast<To>(d));
+        });
+    }
+}
+
+BENCHMARK(fdcFastUs, "cast.fast.us", "ns/call") { return perCast<us, true>(); }
+BENCHMARK(fdcStdUs, "cast.std.us", "ns/call") { return perCast<us, false>(); }
+BENCHMARK(fdcFastNs, "cast.fast.ns", "ns/call") { return perCast<ns, true>(); }
+BENCHMARK(fdcStdNs, "cast.std.ns", "ns/call") { return perCast<ns, false>(); }
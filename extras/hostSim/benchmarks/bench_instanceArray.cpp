@@ -0,0 +1,75 @@
+// Per tick iteration cost: InstanceList vs. InstanceArray (range for, for_each, hot fields)
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "instanceArray.h"
+#include "instanceList.h"
+#include <memory>
+
+namespace
+{
+    constexpr unsigned nrOfInstances = 500;
+
+    struct Motion
+    {
+        float pos, vel;
+    };
+
+    struct ListAxis : InstanceList<ListAxis>
+    {
+        Motion m{0, 1};
+        char payload[40]; // the rest of the object, spreads the hot fields like in real classes
+        using InstanceList::instanceList;
+    };
+
+    struct ArrayAxis : InstanceArray<ArrayAxis, nrOfInstances, Motion>
+    {
+        ArrayAxis() { hot().vel = 1; }
+        char payload[40];
+        using InstanceArray::for_each;
+        using InstanceArray::for_each_hot;
+        using InstanceArray::hot;
+        using InstanceArray::instanceList;
+    };
+
+    // separately allocated, like objects created at different times
+    template <typename T>
+    std::unique_ptr<T>* create()
+    {
+        static std::unique_ptr<T> objects[nrOfInstances];
+        for (auto& o : objects) o = std::make_unique<T>();
+        return objects;
+    }
+    auto listObjects  = create<ListAxis>();
+    auto arrayObjects = create<ArrayAxis>();
+
+    constexpr float dt = 1E-3f;
+}
+
+BENCHMARK(tickList, "instanceTick.list", "ns")
+{
+    return bench::nsPerCall([] {
+        for (ListAxis& a : ListAxis::instanceList) a.m.pos += a.m.vel * dt;
+    }, 10'000);
+}
+
+BENCHMARK(tickArray, "instanceTick.array", "ns")
+{
+    return bench::nsPerCall([] {
+        for (ArrayAxis& a : ArrayAxis::instanceList) a.hot().pos += a.hot().vel * dt;
+    }, 10'000);
+}
+
+BENCHMARK(tickForEach, "instanceTick.for_each", "ns")
+{
+    return bench::nsPerCall([] {
+        ArrayAxis::for_each([](ArrayAxis& a) { a.hot().pos += a.hot().vel * dt; });
+    }, 10'000);
+}
+
+BENCHMARK(tickHot, "instanceTick.for_each_hot", "ns")
+{
+    return bench::nsPerCall([] {
+        ArrayAxis::for_each_hot([](Motion& m) { m.pos += m.vel * dt; });
+    }, 10'000);
+}
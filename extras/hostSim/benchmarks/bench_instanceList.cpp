@@ -0,0 +1,31 @@
+// InstanceList: construction and destruction of 10k instances (destroyed in random order)
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "instanceList.h"
+#include <algorithm>
+#include <new>
+#include <random>
+
+namespace
+{
+    struct Node : InstanceList<Node>
+    {
+    };
+
+    constexpr unsigned nrOfNodes = 10'000;
+    alignas(Node) uint8_t storage[nrOfNodes][sizeof(Node)];
+    unsigned order[nrOfNodes];
+}
+
+BENCHMARK(instanceList10k, "instanceList.createDestroy10k", "ns")
+{
+    for (unsigned i = 0; i < nrOfNodes; i++) order[i] = i;
+    std::shuffle(order, order + nrOfNodes, std::mt19937(1));
+
+    double ns = bench::nsPerCall([] {
+        for (auto& s : storage) new (s) Node;
+        for (unsigned i : order) ((Node*)storage[i])->~Node();
+    }, 10);
+    return ns / nrOfNodes; // per instance
+}
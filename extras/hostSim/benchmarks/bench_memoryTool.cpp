@@ -0,0 +1,48 @@
+// MemoryTool reports: printf path (doPrintT4) vs. binary records (doWrite)
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "memoryTool.h"
+
+namespace
+{
+    class NullStream : public Stream
+    {
+     public:
+        size_t write(uint8_t) override { return 1; }
+        size_t write(const uint8_t*, size_t size) override { return size; }
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+    };
+
+    NullStream nullStream;
+    uint32_t someArray[100];
+
+    void printReport() { MemoryTool::doPrintT4("someArray", someArray, sizeof(uint32_t), 100); }
+    void writeReport() { MemoryTool::doWrite("someArray", someArray, sizeof(uint32_t), 100); }
+}
+
+BENCHMARK(memPrint, "memoryTool.print", "ns")
+{
+    MemoryTool::setStream(nullStream);
+    return bench::nsPerCall(printReport, 10'000);
+}
+
+BENCHMARK(memWrite, "memoryTool.write", "ns")
+{
+    MemoryTool::setStream(nullStream);
+    return bench::nsPerCall(writeReport);
+}
+
+BENCHMARK(memPrintStack, "memoryTool.print.stack", "bytes")
+{
+    MemoryTool::setStream(nullStream);
+    return bench::stackBytes(printReport);
+}
+
+BENCHMARK(memWriteStack, "memoryTool.write.stack", "bytes")
+{
+    MemoryTool::setStream(nullStream);
+    return bench::stackBytes(writeReport);
+}
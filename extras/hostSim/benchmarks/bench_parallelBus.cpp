@@ -0,0 +1,47 @@
+// ParallelBus write/read on contiguous and scattered pins vs. one digitalWriteFast per pin
+
+#include "Arduino.h"
+#include "ParallelBus.h"
+#include "benchmark.h"
+
+namespace
+{
+    ParallelBus<19, 18, 14, 15> contiguousBus;                 // GPIO6 bits 16..19
+    ParallelBus<10, 12, 11, 13, 6, 9, 8, 7> scatteredBus;      // GPIO7 bits 0..3, 10, 11, 16, 17
+    constexpr uint8_t scatteredPins[] = {10, 12, 11, 13, 6, 9, 8, 7};
+}
+
+BENCHMARK(parallelBusContiguous, "parallelBus.write.contiguous", "ns")
+{
+    sim::reset();
+    contiguousBus.pinMode(OUTPUT);
+    uint8_t v = 0;
+    return bench::nsPerCall([&] { contiguousBus = v++; });
+}
+
+BENCHMARK(parallelBusScattered, "parallelBus.write.scattered", "ns")
+{
+    sim::reset();
+    scatteredBus.pinMode(OUTPUT);
+    uint8_t v = 0;
+    return bench::nsPerCall([&] { scatteredBus = v++; });
+}
+
+BENCHMARK(parallelBusRead, "parallelBus.read.scattered", "ns")
+{
+    sim::reset();
+    scatteredBus.pinMode(OUTPUT);
+    scatteredBus = 0xA5;
+    return bench::nsPerCall([&] { bench::doNotOptimize((uint8_t)scatteredBus); });
+}
+
+BENCHMARK(parallelBusPerPin, "parallelBus.digitalWriteFast", "ns")
+{
+    sim::reset();
+    scatteredBus.pinMode(OUTPUT);
+    uint8_t v = 0;
+    return bench::nsPerCall([&] {
+        for (unsigned i = 0; i < 8; i++) digitalWriteFast(scatteredPins[i], (v >> i) & 1);
+        v++;
+    });
+}
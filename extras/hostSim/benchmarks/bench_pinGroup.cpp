@@ -0,0 +1,30 @@
+// PinGroup::write vs. one digitalWriteFast per pin, 8 pins on two ports
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "pinModeEx.h"
+
+namespace
+{
+    constexpr uint8_t pins[] = {2, 3, 4, 5, 14, 15, 16, 17}; // GPIO9 and GPIO6
+    constexpr PinGroup group{2, 3, 4, 5, 14, 15, 16, 17};
+}
+
+BENCHMARK(pinGroupWrite, "pinGroup.write", "ns")
+{
+    sim::reset();
+    group.pinMode(OUTPUT);
+    uint32_t v = 0;
+    return bench::nsPerCall([&] { group.write(v++); });
+}
+
+BENCHMARK(pinGroupPerPin, "pinGroup.digitalWriteFast", "ns")
+{
+    sim::reset();
+    group.pinMode(OUTPUT);
+    uint32_t v = 0;
+    return bench::nsPerCall([&] {
+        for (unsigned i = 0; i < 8; i++) digitalWriteFast(pins[i], (v >> i) & 1);
+        v++;
+    });
+}
@@ -0,0 +1,92 @@
+// Sustainable edge rate: callback (attachInterruptEx + lambda) vs. counting mode vs. quadrature
+// decoder. Four encoders (pins 0/1, 2/3, 4/5, 6/7) step at the same time, i.e. one isr entry
+// handles 4 edges like in dispatch.burst. The cost of the simulated edges themselves
+// (sim::setPin without attached interrupt) is subtracted.
+
+#include "Arduino.h"
+#include "attachInterruptEx.h"
+#include "benchmark.h"
+#include "cycles64.h"
+
+namespace
+{
+    constexpr unsigned nrOfEncoders = 4;
+    volatile int32_t edges;
+
+    double nsPerEdge() // quadrature sequence, one edge per encoder and call, alternating on A and B
+    {
+        static const uint8_t sequence[4] = {0b00, 0b10, 0b11, 0b01};
+        unsigned phase = 0;
+        return bench::nsPerCall([&] {
+            phase = (phase + 1) & 3;
+            noInterrupts();
+            for (unsigned e = 0; e < nrOfEncoders; e++)
+            {
+                if (phase & 1)
+                    sim::setPin(2 * e, sequence[phase] & 2);
+                else
+                    sim::setPin(2 * e + 1, sequence[phase] & 1);
+            }
+            interrupts();
+        }, 20'000) / nrOfEncoders;
+    }
+
+    void setup()
+    {
+        sim::reset();
+        cycles64::begin();
+        for (unsigned pin = 0; pin < 2 * nrOfEncoders; pin++) pinMode(pin, INPUT);
+    }
+
+    void detachAll()
+    {
+        for (unsigned pin = 0; pin < 2 * nrOfEncoders; pin++) detachInterrupt(pin);
+    }
+
+    double baseline()
+    {
+        static double ns = 0;
+        if (ns == 0)
+        {
+            setup();
+            ns = nsPerEdge();
+        }
+        return ns;
+    }
+
+    double edgeRate(double ns) // Medges/s
+    {
+        double base = baseline();
+        return 1E3 / (ns > base ? ns - base : 1E-3);
+    }
+}
+
+BENCHMARK(pulseCallback, "pulse.callback", "Medges/s")
+{
+    baseline();
+    setup();
+    for (unsigned pin = 0; pin < 2 * nrOfEncoders; pin++) attachInterruptEx(pin, [] { edges = edges + 1; }, CHANGE);
+    double ns = nsPerEdge();
+    detachAll();
+    return edgeRate(ns);
+}
+
+BENCHMARK(pulseCounter, "pulse.counter", "Medges/s")
+{
+    baseline();
+    setup();
+    for (unsigned pin = 0; pin < 2 * nrOfEncoders; pin++) attachCounterInterruptEx(pin, CHANGE);
+    double ns = nsPerEdge();
+    detachAll();
+    return edgeRate(ns);
+}
+
+BENCHMARK(pulseQuadrature, "pulse.quadrature", "Medges/s")
+{
+    baseline();
+    setup();
+    for (unsigned e = 0; e < nrOfEncoders; e++) attachQuadratureInterruptEx(2 * e, 2 * e + 1);
+    double ns = nsPerEdge();
+    detachAll();
+    return edgeRate(ns);
+}
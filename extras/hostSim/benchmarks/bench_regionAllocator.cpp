@@ -0,0 +1,57 @@
+// Arena and Pool: allocation cost, and a std::list on a Pool compared to the heap
+// (host: compare regionAllocator.list.pool with regionAllocator.list.heap)
+
+#include "Arduino.h"
+#include "benchmark.h"
+#include "regionAllocator.h"
+#include <list>
+
+using namespace MemoryTool;
+
+namespace
+{
+    alignas(16) uint8_t arenaMem[64 * 1024];
+    alignas(16) uint8_t poolMem[64 * 1024];
+
+    constexpr int nrOfNodes = 1000;
+
+    template <class List>
+    void fillAndClear(List& list)
+    {
+        for (int i = 0; i < nrOfNodes; i++) list.push_back(i);
+        bench::doNotOptimize(list.back());
+        list.clear();
+    }
+}
+
+BENCHMARK(regionArena, "regionAllocator.arena", "ns")
+{
+    static Arena arena(arenaMem, "bench");
+    return bench::nsPerCall([] {
+        for (int i = 0; i < 100; i++) bench::doNotOptimize(arena.allocate(24));
+        arena.reset();
+    }, 10'000) / 100; // per allocation
+}
+
+BENCHMARK(regionPool, "regionAllocator.pool", "ns")
+{
+    static Pool pool(poolMem, 32, "bench");
+    return bench::nsPerCall([] {
+        void* p = pool.allocate(24);
+        bench::doNotOptimize(p);
+        pool.deallocate(p);
+    }); // allocation + deallocation
+}
+
+BENCHMARK(regionListPool, "regionAllocator.list.pool", "ns")
+{
+    static Pool pool(poolMem, 32, "list");
+    static std::list<int, RegionAllocator<int, Pool>> list(pool);
+    return bench::nsPerCall([] { fillAndClear(list); }, 1000) / nrOfNodes; // per node
+}
+
+BENCHMARK(regionListHeap, "regionAllocator.list.heap", "ns")
+{
+    static std::list<int> list;
+    return bench::nsPerCall([] { fillAndClear(list); }, 1000) / nrOfNodes;
+}
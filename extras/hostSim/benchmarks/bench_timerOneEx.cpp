@@ -0,0 +1,58 @@
+// TimerOneEx: latency from the timer isr to the callback for the different bindings
+
+#include "Arduino.h"
+#include "TimerOneEx.h"
+#include "benchmark.h"
+
+namespace
+{
+    volatile uint32_t calls = 0;
+
+    struct Motor
+    {
+        void step() { calls++; }
+    };
+
+    Motor motor;
+    TimerOneEx<Motor> timer;
+
+    void plain() { calls++; }
+    const auto lambda = [] { calls++; };
+
+    double isrLatency()
+    {
+        return bench::nsPerCall(TimerOne::isr);
+    }
+}
+
+BENCHMARK(t1Plain, "timerOneEx.plainFunction", "ns")
+{
+    Timer1.attachInterrupt(plain);
+    return isrLatency();
+}
+
+BENCHMARK(t1MemberPtr, "timerOneEx.memberPointer", "ns")
+{
+    timer.attachInterrupt(&Motor::step, &motor);
+    return isrLatency();
+}
+
+BENCHMARK(t1Member, "timerOneEx.templateMember", "ns")
+{
+    timer.attachInterrupt<&Motor::step>(&motor);
+    return isrLatency();
+}
+
+BENCHMARK(t1Direct, "timerOneEx.direct", "ns")
+{
+    timer.attachInterrupt<motor, &Motor::step>();
+    return isrLatency();
+}
+
+BENCHMARK(t1Lambda, "timerOneEx.lambda", "ns")
+{
+    timer.attachInterrupt(lambda);
+    double ns = isrLatency();
+    timer.stop();
+    return ns;
+}
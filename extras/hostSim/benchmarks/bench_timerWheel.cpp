@@ -0,0 +1,48 @@
+// TimerWheel: cost of an idle tick and dispatch cost per expiring timer
+
+#include "Arduino.h"
+#include "TimerWheel.h"
+#include "benchmark.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr unsigned nrOfTimers = 1000;
+    TimerWheel wheel; // outlives the timers
+    TimerWheel::Timer timers[nrOfTimers];
+
+    void setup()
+    {
+        sim::reset();
+        wheel.begin(1ms);
+        wheel.end(); // ticks are driven by the benchmarks
+    }
+    volatile unsigned calls;
+}
+
+BENCHMARK(wheelIdle, "timerWheel.tickIdle", "ns/tick")
+{
+    setup();
+    return bench::nsPerCall([&] { wheel.tick(); });
+}
+
+BENCHMARK(wheelDispatch, "timerWheel.dispatch", "ns/timer")
+{
+    setup();
+    for (auto& t : timers) wheel.startPeriodic(t, [] { calls = calls + 1; }, 1ms); // all timers expire on every tick
+    double ns = bench::nsPerCall([&] { wheel.tick(); }, 100) / nrOfTimers;
+    for (auto& t : timers) wheel.cancel(t);
+    return ns;
+}
+
+BENCHMARK(wheelStart, "timerWheel.startCancel", "ns/call")
+{
+    setup();
+    unsigned i = 0;
+    double ns  = bench::nsPerCall([&] {
+        wheel.start(timers[0], [] {}, std::chrono::milliseconds(++i & 0xFFFF));
+        wheel.cancel(timers[0]);
+    });
+    return ns;
+}
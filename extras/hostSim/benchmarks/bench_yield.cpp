@@ -0,0 +1,39 @@
+// Cost per task call: YieldScheduler vs. one retriggering EventResponder per task
+
+#include "Arduino.h"
+#include "EventResponder.h"
+#include "attachYieldFunc.h"
+#include "benchmark.h"
+
+namespace
+{
+    constexpr unsigned nrOfTasks = 8;
+    volatile unsigned calls;
+
+    void task() { calls = calls + 1; }
+}
+
+BENCHMARK(yieldEventResponder, "yield.eventResponder", "ns/task")
+{
+    sim::reset();
+    EventResponder responders[nrOfTasks];
+    for (auto& r : responders)
+    {
+        r.attach([](EventResponderRef r) {
+            task();
+            r.triggerEvent();
+        });
+        r.triggerEvent();
+    }
+    return bench::nsPerCall([] { yield(); }); // the core calls one responder per yield
+}
+
+BENCHMARK(yieldScheduler, "yield.scheduler", "ns/task")
+{
+    sim::reset();
+    int ids[nrOfTasks];
+    for (int& id : ids) id = YieldScheduler::addTask(task);
+    double ns = bench::nsPerCall([] { yield(); }) / nrOfTasks;
+    for (int id : ids) YieldScheduler::removeTask(id);
+    return ns;
+}
@@ -0,0 +1,84 @@
+// Benchmark runner: usage: benchmarks [thresholds.txt]
+//
+// thresholds.txt contains one line per figure: <name> <max|min> <limit>
+// Lines starting with # are ignored. Figures without a threshold are only printed.
+
+#include "benchmark.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace bench
+{
+    namespace
+    {
+        Entry* first = nullptr;
+        Entry* last  = nullptr;
+
+        struct Limit
+        {
+            bool isMax;
+            double value;
+        };
+    }
+
+    bool add(Entry* entry) // keeps the registration order
+    {
+        if (last)
+            last->next = entry;
+        else
+            first = entry;
+        last = entry;
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::map<std::string, bench::Limit> limits;
+    if (argc > 1)
+    {
+        std::ifstream file(argv[1]);
+        if (!file)
+        {
+            printf("can't open %s\n", argv[1]);
+            return 1;
+        }
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream in(line);
+            std::string name, kind;
+            double value;
+            if (line.empty() || line[0] == '#' || !(in >> name >> kind >> value)) continue;
+            limits[name] = bench::Limit{kind == "max", value};
+        }
+    }
+
+    setvbuf(stdout, nullptr, _IOLBF, 0); // show the figures while the benchmarks run
+
+    int failed = 0;
+    printf("%-36s %12s %-8s %12s\n", "benchmark", "value", "unit", "limit");
+    for (bench::Entry* e = bench::first; e != nullptr; e = e->next)
+    {
+        double value = e->fn();
+        auto limit   = limits.find(e->name);
+
+        if (limit == limits.end())
+        {
+            printf("%-36s %12.2f %-8s %12s\n", e->name, value, e->unit, "-");
+            continue;
+        }
+
+        const bench::Limit& l = limit->second;
+        bool ok               = l.isMax ? value <= l.value : value >= l.value;
+        if (!ok) failed++;
+        printf("%-36s %12.2f %-8s %s %9.2f %s\n", e->name, value, e->unit, l.isMax ? "<=" : ">=", l.value, ok ? "" : " FAILED");
+    }
+
+    if (failed) printf("\n%d figure(s) out of limits\n", failed);
+    return failed ? 1 : 0;
+}
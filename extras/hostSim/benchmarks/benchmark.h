@@ -0,0 +1,133 @@
+#pragma once
+/************************************************************************************
+ * Minimal benchmark registry for the host simulation
+ *
+ * BENCHMARK(id, "name", "unit") { ...; return figure; }
+ *
+ * defines a benchmark which returns one figure (e.g. ns per call or MB/s). The runner
+ * (benchmark.cpp) prints all figures and compares them to the limits stored in
+ * thresholds.txt. It fails (exit code 1) if a figure exceeds its limit.
+ *
+ * Figures are host wall clock times of the simulated code. They don't predict the
+ * timing on a Teensy, they are meant to catch regressions (e.g. an accidental heap
+ * allocation or a lost fast path) and to compare two implementations.
+ ************************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ucontext.h>
+
+namespace bench
+{
+    struct Entry
+    {
+        const char* name;
+        const char* unit;
+        double (*fn)();
+        Entry* next;
+    };
+
+    bool add(Entry* entry);
+
+    template <typename T>
+    inline void doNotOptimize(const T& value)
+    {
+        asm volatile("" ::"r,m"(value) : "memory");
+    }
+
+    // calls f n times per round and returns the time per call (ns) of the fastest of 7 rounds
+    template <typename F>
+    double nsPerCall(F&& f, unsigned n = 100'000)
+    {
+        using clock = std::chrono::steady_clock;
+
+        double best = 1e30;
+        for (int round = 0; round < 7; round++)
+        {
+            auto t0 = clock::now();
+            for (unsigned i = 0; i < n; i++) f();
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count() / n;
+            if (ns < best) best = ns;
+        }
+        return best;
+    }
+
+    // host cycle counter (x86 TSC), stands in for ARM_DWT_CYCCNT. Falls back to ns on other hosts
+    inline uint64_t cycles()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // calls f n times per round and returns the cycles of the slowest call (worst case). Of 31
+    // short rounds the one with the lowest maximum is taken, preemption by the host OS (every
+    // few ms) only spoils single rounds. Keep n * cycles of f well below a millisecond
+    template <typename F>
+    double maxCyclesPerCall(F&& f, unsigned n = 1000)
+    {
+        uint64_t best = UINT64_MAX;
+        for (int round = 0; round < 31; round++)
+        {
+            uint64_t worst = 0;
+            for (unsigned i = 0; i < n; i++)
+            {
+                uint64_t t0 = cycles();
+                f();
+                uint64_t dt = cycles() - t0;
+                if (dt > worst) worst = dt;
+            }
+            if (worst < best) best = worst;
+        }
+        return (double)best;
+    }
+
+    namespace detail
+    {
+        inline void (*stackFn)(void*) = nullptr;
+        inline void* stackArg         = nullptr;
+        inline void stackEntry() { stackFn(stackArg); }
+
+        inline size_t runOnPaintedStack(void (*fn)(void*), void* arg)
+        {
+            constexpr uint8_t pattern = 0xA5;
+            static uint8_t stack[256 * 1024];
+            static ucontext_t caller, callee;
+
+            memset(stack, pattern, sizeof(stack));
+            stackFn  = fn;
+            stackArg = arg;
+            getcontext(&callee);
+            callee.uc_stack.ss_sp   = stack;
+            callee.uc_stack.ss_size = sizeof(stack);
+            callee.uc_link          = &caller;
+            makecontext(&callee, stackEntry, 0);
+            swapcontext(&caller, &callee);
+
+            size_t untouched = 0; // the stack grows down
+            while (untouched < sizeof(stack) && stack[untouched] == pattern) untouched++;
+            return sizeof(stack) - untouched;
+        }
+    }
+
+    // runs f once on a painted stack and returns the number of stack bytes used by f
+    template <typename F>
+    double stackBytes(F&& f)
+    {
+        auto fn     = [&f] { f(); };
+        auto call   = [](void* p) { (*(decltype(fn)*)p)(); };
+        auto empty  = [](void*) {};
+        size_t used = detail::runOnPaintedStack(call, &fn);
+        size_t base = detail::runOnPaintedStack(empty, nullptr); // context switch overhead
+        return used > base ? used - base : 0;
+    }
+}
+
+#define BENCHMARK(id, name, unit)                                  \
+    static double bench_##id();                                    \
+    static bench::Entry bench_entry_##id{name, unit, bench_##id, nullptr}; \
+    static bool bench_added_##id = bench::add(&bench_entry_##id);  \
+    static double bench_##id()
@@ -0,0 +1,83 @@
+#pragma once
+/************************************************************************************
+ * Simulated pin functions of the Teensy 4.1 (default) or MicroMod core
+ ************************************************************************************/
+
+#include "imxrt.h"
+#include <cstdint>
+
+#if defined(ARDUINO_TEENSY_MICROMOD)
+    #define CORE_NUM_TOTAL_PINS 46
+    #define CORE_NUM_DIGITAL    46
+    #define CORE_NUM_INTERRUPT  46
+#else // T4.1
+    #define CORE_NUM_TOTAL_PINS 55
+    #define CORE_NUM_DIGITAL    55
+    #define CORE_NUM_INTERRUPT  55
+#endif
+
+constexpr uint8_t A0 = 14, A1 = 15, A2 = 16, A3 = 17, A4 = 18, A5 = 19, A6 = 20, A7 = 21, A8 = 22;
+constexpr uint8_t A9 = 23, A10 = 24, A11 = 25, A12 = 26, A13 = 27, A14 = 38, A15 = 39, A16 = 40, A17 = 41;
+
+#define HIGH 1
+#define LOW  0
+
+#define INPUT            0
+#define OUTPUT           1
+#define INPUT_PULLUP     2
+#define INPUT_PULLDOWN   3
+#define OUTPUT_OPENDRAIN 4
+#define INPUT_DISABLE    5
+
+#define FALLING 2
+#define RISING  3
+#define CHANGE  4
+
+struct digital_pin_bitband_and_config_table_struct
+{
+    volatile uint32_t* reg;
+    volatile uint32_t* mux;
+    volatile uint32_t* pad;
+    uint32_t mask;
+};
+extern const struct digital_pin_bitband_and_config_table_struct digital_pin_to_info_PGM[];
+
+#define digitalPinToPortReg(pin) (digital_pin_to_info_PGM[(pin)].reg)
+#define digitalPinToBitMask(pin) (digital_pin_to_info_PGM[(pin)].mask)
+#define portOutputRegister(pin)  ((digital_pin_to_info_PGM[(pin)].reg + 0))
+#define portSetRegister(pin)     ((digital_pin_to_info_PGM[(pin)].reg + 33))
+#define portClearRegister(pin)   ((digital_pin_to_info_PGM[(pin)].reg + 34))
+#define portToggleRegister(pin)  ((digital_pin_to_info_PGM[(pin)].reg + 35))
+#define portInputRegister(pin)   ((digital_pin_to_info_PGM[(pin)].reg + 2))
+#define portModeRegister(pin)    ((digital_pin_to_info_PGM[(pin)].reg + 1))
+#define portConfigRegister(pin)  ((digital_pin_to_info_PGM[(pin)].mux))
+#define digitalPinToInterrupt(pin) (pin)
+
+#define interrupts()   __enable_irq()
+#define noInterrupts() __disable_irq()
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+uint8_t digitalRead(uint8_t pin);
+void digitalToggle(uint8_t pin);
+
+inline void digitalWriteFast(uint8_t pin, uint8_t val) { digitalWrite(pin, val); }
+inline uint8_t digitalReadFast(uint8_t pin) { return digitalRead(pin); }
+inline void digitalToggleFast(uint8_t pin) { digitalToggle(pin); }
+
+void attachInterrupt(uint8_t pin, void (*function)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t msec);
+void delayMicroseconds(uint32_t usec);
+void delayNanoseconds(uint32_t nsec);
+void yield();
+
+unsigned long rtc_get();
+void rtc_set(unsigned long t);
+
+inline void arm_dcache_flush(void*, uint32_t) {}
+inline void arm_dcache_delete(void*, uint32_t) {}
+inline void arm_dcache_flush_delete(void*, uint32_t) {}
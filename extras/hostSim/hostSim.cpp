@@ -0,0 +1,672 @@
+#include "Arduino.h"
+#include "EventResponder.h"
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+
+void (*_VectorsRam[NVIC_NUM_INTERRUPTS + 16])(void);
+
+volatile uint32_t simDebugRegs[2];
+volatile uint32_t simSnvsRegs[2];
+volatile uint32_t simGprRegs[4]{0xFFFF'FFFF, 0xFFFF'FFFF, 0xFFFF'FFFF, 0xFFFF'FFFF}; // startup code routes all pins to GPIO6..9
+volatile uint32_t simCcmRegs[2];
+volatile uint32_t simPitMcr;
+IMXRT_PIT_CHANNEL_t simPitChannels[4];
+volatile uint16_t simXbarRegs[68];
+
+usb_serial_class Serial;
+
+namespace sim
+{
+    namespace // private -----------------------------
+    {
+        constexpr unsigned nrOfPins   = CORE_NUM_DIGITAL;
+        constexpr unsigned bankWords  = 0x4000 / 4; // GPIO banks are 0x4000 apart
+        constexpr unsigned DR = 0, GDIR = 1, PSR = 2, IMR = 5, ISR = 6, DR_SET = 33, DR_CLEAR = 34, DR_TOGGLE = 35;
+
+        alignas(64) volatile uint32_t gpio[9][bankWords]; // GPIO1 ... GPIO9
+
+        struct Pin
+        {
+            uint8_t port; // fast GPIO6..9
+            uint8_t bit;
+        };
+
+        constexpr Pin pins[nrOfPins] = {
+            {6, 3}, {6, 2}, {9, 4}, {9, 5}, {9, 6}, {9, 8}, {7, 10}, {7, 17}, {7, 16}, {7, 11},      //  0 -  9
+            {7, 0}, {7, 2}, {7, 1}, {7, 3}, {6, 18}, {6, 19}, {6, 23}, {6, 22}, {6, 17}, {6, 16},    // 10 - 19
+            {6, 26}, {6, 27}, {6, 24}, {6, 25}, {6, 12}, {6, 13}, {6, 30}, {6, 31}, {8, 18}, {9, 31}, // 20 - 29
+            {8, 23}, {8, 22}, {7, 12}, {9, 7},                                                        // 30 - 33
+#if defined(ARDUINO_TEENSY_MICROMOD)
+            {8, 15}, {8, 14}, {8, 13}, {8, 12}, {8, 16}, {8, 17},                                     // 34 - 39
+            {7, 4}, {7, 5}, {7, 6}, {7, 7}, {7, 8}, {7, 9},                                           // 40 - 45
+#else // T4.1
+            {7, 29}, {7, 28}, {7, 18}, {7, 19}, {6, 28}, {6, 29}, {6, 20}, {6, 21}, {8, 15}, {8, 14}, // 34 - 43
+            {8, 13}, {8, 12}, {8, 17}, {8, 16}, {9, 24}, {9, 27}, {9, 28}, {9, 22}, {9, 26}, {9, 25}, // 44 - 53
+            {9, 29},                                                                                  // 54
+#endif
+        };
+
+        struct Timer
+        {
+            void (*isr)();
+            uint64_t period;
+            uint64_t next;
+            bool active;
+            bool flag;
+        };
+
+        struct State
+        {
+            uint64_t now        = 0;
+            uint64_t lastSync   = 0; // time of the last cycle counter update
+            uint64_t nextSecond = F_CPU;
+            uint32_t readCost   = 1;
+            uint32_t rtcBase    = 0;
+            uint32_t rtcEdges   = 0;     // RTC seconds since reset
+            double secondLength = F_CPU; // cycles per RTC second, differs from F_CPU with a crystal error
+            double secondFrac   = 0;     // fractional part of the next edge time
+
+            bool masked                  = false;
+            unsigned activePriority      = 256;     // priority of the running handler, 256: thread mode
+            volatile uint32_t* exclusive = nullptr; // address tagged by the exclusive monitor
+            uint32_t strexFailures       = 0;
+            bool pending[NVIC_NUM_INTERRUPTS]{};
+            unsigned nrPending = 0; // number of set pending flags, deliver() returns early if none
+            bool enabled[NVIC_NUM_INTERRUPTS]{};
+            uint8_t priority[NVIC_NUM_INTERRUPTS]{};
+
+            uint32_t ext[4]{}; // externally driven levels of the fast ports
+            uint32_t driven[4]{};
+            void (*pinIsr[nrOfPins])(){};
+            int pinIsrMode[nrOfPins]{};
+
+            Timer timers[4]{};
+        } state; // constant initialized, i.e. valid for static initializers of other translation units which read the cycle counter
+
+        volatile uint32_t cyccntReg; // the register the macro ARM_DWT_CYCCNT refers to
+
+        inline volatile uint32_t* bank(unsigned port) { return gpio[port - 1]; }
+
+        inline volatile uint32_t* slowBank(unsigned port) { return gpio[port - 6]; } // GPIO6..9 -> GPIO1..4
+
+        // level of a pin, takes the routing between fast and normal GPIO into account
+        bool level(unsigned pin)
+        {
+            const Pin& p             = pins[pin];
+            uint32_t mask            = 1UL << p.bit;
+            bool fast                = simGprRegs[p.port - 6] & mask;
+            volatile uint32_t* regs  = fast ? bank(p.port) : slowBank(p.port);
+
+            if (regs[GDIR] & mask) return regs[DR] & mask;
+            return state.ext[p.port - 6] & mask;
+        }
+
+        void updatePSR()
+        {
+            for (unsigned port = 6; port <= 9; port++)
+            {
+                for (volatile uint32_t* regs : {bank(port), slowBank(port)})
+                {
+                    regs[PSR] = (regs[DR] & regs[GDIR]) | (state.ext[port - 6] & ~regs[GDIR]);
+                }
+            }
+        }
+
+        void ackHandler(unsigned irq)
+        {
+            if (irq == IRQ_GPIO6789)
+            {
+                for (unsigned port = 6; port <= 9; port++) bank(port)[ISR] &= ~bank(port)[IMR];
+            }
+            else if (irq == IRQ_SNVS_IRQ)
+            {
+                SNVS_HPSR = 0;
+            }
+        }
+
+        // calls the vectors of all pending interrupts, highest priority (lowest value) first.
+        // A pending interrupt preempts a running handler only if its priority is higher.
+        void setPending(unsigned irq)
+        {
+            if (!state.pending[irq]) state.nrPending++;
+            state.pending[irq] = true;
+        }
+
+        void deliver()
+        {
+            while (!state.masked && state.nrPending != 0)
+            {
+                int irq = -1;
+                for (unsigned i = 0; i < NVIC_NUM_INTERRUPTS; i++)
+                {
+                    if (state.pending[i] && state.enabled[i] && state.priority[i] < state.activePriority && (irq < 0 || state.priority[i] < state.priority[irq])) irq = i;
+                }
+                if (irq < 0) return;
+
+                unsigned preempted   = state.activePriority;
+                state.pending[irq]   = false;
+                state.nrPending--;
+                state.activePriority = state.priority[irq];
+                state.exclusive      = nullptr;
+                if (_VectorsRam[irq + 16]) _VectorsRam[irq + 16]();
+                ackHandler(irq);
+                state.exclusive      = nullptr;
+                state.activePriority = preempted;
+            }
+        }
+
+        // time of the next timer or rtc event
+        uint64_t nextEvent()
+        {
+            uint64_t next = state.nextSecond;
+            for (const Timer& t : state.timers)
+            {
+                if (t.active && t.next < next) next = t.next;
+            }
+            return next;
+        }
+
+        // fires all events which are due at the current time, in chronological order
+        void runDue()
+        {
+            uint64_t t;
+            while ((t = nextEvent()) <= state.now)
+            {
+                for (Timer& timer : state.timers)
+                {
+                    if (timer.active && timer.next == t)
+                    {
+                        timer.flag = true;
+                        timer.next += timer.period;
+                        setPending(IRQ_PIT);
+                    }
+                }
+                if (state.nextSecond == t)
+                {
+                    double next       = state.secondFrac + state.secondLength;
+                    uint64_t whole    = (uint64_t)next;
+                    state.secondFrac  = next - whole;
+                    state.nextSecond += whole;
+                    state.rtcEdges++;
+                    if (SNVS_HPCR & SNVS_HPCR_PI_EN)
+                    {
+                        SNVS_HPSR |= 0b10;
+                        setPending(IRQ_SNVS_IRQ);
+                    }
+                }
+                deliver();
+            }
+        }
+
+        void pitIsr()
+        {
+            for (Timer& t : state.timers)
+            {
+                if (t.flag)
+                {
+                    t.flag = false;
+                    if (t.isr) t.isr();
+                }
+            }
+        }
+
+        void gpioIsr() // same as the core: calls the attached function of all flagged pins
+        {
+            for (unsigned port = 6; port <= 9; port++)
+            {
+                uint32_t status = bank(port)[ISR] & bank(port)[IMR];
+                bank(port)[ISR] &= ~status;
+                for (unsigned pin = 0; pin < nrOfPins; pin++)
+                {
+                    if (pins[pin].port == port && (status & (1UL << pins[pin].bit)) && state.pinIsr[pin]) state.pinIsr[pin]();
+                }
+            }
+        }
+    } // end private namespace <<---------------------
+
+    void reset()
+    {
+        for (auto& regs : gpio)
+        {
+            for (volatile uint32_t& r : regs) r = 0;
+        }
+        for (auto& v : _VectorsRam) v = nullptr;
+        for (volatile uint32_t& r : simGprRegs) r = 0xFFFF'FFFF;
+        for (volatile uint32_t& r : simCcmRegs) r = 0;
+        for (auto& c : simPitChannels) c.LDVAL = c.CVAL = c.TCTRL = c.TFLG = 0;
+        for (volatile uint16_t& r : simXbarRegs) r = 0;
+        simPitMcr = 0;
+        SNVS_HPCR = SNVS_HPSR = 0;
+        ARM_DEMCR = ARM_DWT_CTRL = 0;
+        cyccntReg = 0;
+
+        state = State{};
+        for (uint8_t& p : state.priority) p = 128; // same default as the core
+    }
+
+    uint64_t cycles()
+    {
+        return state.now;
+    }
+
+    void advance(uint64_t cycles)
+    {
+        uint64_t target = state.now + cycles;
+        uint64_t t;
+        while ((t = nextEvent()) <= target)
+        {
+            if (t > state.now) state.now = t;
+            runDue();
+        }
+        if (target > state.now) state.now = target;
+    }
+
+    void advanceMicros(double us)
+    {
+        advance((uint64_t)(us * (F_CPU / 1'000'000)));
+    }
+
+    void setPin(unsigned pin, bool value)
+    {
+        if (pin >= nrOfPins) return;
+        sync();
+
+        const Pin& p  = pins[pin];
+        uint32_t mask = 1UL << p.bit;
+        bool old      = level(pin);
+
+        state.driven[p.port - 6] |= mask;
+        if (value)
+            state.ext[p.port - 6] |= mask;
+        else
+            state.ext[p.port - 6] &= ~mask;
+        updatePSR();
+
+        bool now = level(pin);
+        if (now == old || !(bank(p.port)[IMR] & mask)) return;
+
+        int mode = state.pinIsrMode[pin];
+        if (mode == CHANGE || (mode == RISING && now) || (mode == FALLING && !now) || (mode == HIGH && now) || (mode == LOW && !now))
+        {
+            bank(p.port)[ISR] |= mask;
+            raise(IRQ_GPIO6789);
+        }
+    }
+
+    bool getPin(unsigned pin)
+    {
+        if (pin >= nrOfPins) return false;
+        sync();
+        return level(pin);
+    }
+
+    void raise(unsigned irq)
+    {
+        if (irq >= NVIC_NUM_INTERRUPTS) return;
+        setPending(irq);
+        deliver();
+    }
+
+    uint32_t strexFailures()
+    {
+        return state.strexFailures;
+    }
+
+    void setReadCost(uint32_t cycles)
+    {
+        state.readCost = cycles;
+    }
+
+    void setRtc(uint32_t seconds)
+    {
+        state.rtcBase = seconds - state.rtcEdges;
+    }
+
+    void setCrystalError(double ppm)
+    {
+        state.secondLength = F_CPU * (1.0 + ppm * 1E-6);
+    }
+
+    //-------------------------------------------------------------------------------
+    // core emulation
+
+    void sync()
+    {
+        for (auto& regs : gpio)
+        {
+            if (regs[DR_SET]) regs[DR] |= regs[DR_SET];
+            if (regs[DR_CLEAR]) regs[DR] &= ~regs[DR_CLEAR];
+            if (regs[DR_TOGGLE]) regs[DR] ^= regs[DR_TOGGLE];
+            regs[DR_SET] = regs[DR_CLEAR] = regs[DR_TOGGLE] = 0;
+        }
+        updatePSR();
+    }
+
+    volatile uint32_t* gpioReg(unsigned port, unsigned index)
+    {
+        sync();
+        return &bank(port)[index];
+    }
+
+    volatile uint32_t* reg(uintptr_t address)
+    {
+        constexpr uintptr_t gpio6 = 0x4200'0000, gpr26 = 0x400A'C068;
+        if (address >= gpio6 && address < gpio6 + 4 * 0x4000 && address % 4 == 0)
+        {
+            sync();
+            return &bank(6 + (address - gpio6) / 0x4000)[(address - gpio6) % 0x4000 / 4];
+        }
+        if (address >= gpr26 && address < gpr26 + 4 * 4 && address % 4 == 0)
+        {
+            return &simGprRegs[(address - gpr26) / 4];
+        }
+        std::fprintf(stderr, "sim::reg: address 0x%08lX is not simulated\n", (unsigned long)address);
+        std::abort();
+    }
+
+    volatile uint32_t* cycleCounter()
+    {
+        cyccntReg += (uint32_t)(state.now - state.lastSync); // keeps values written by the user code
+        state.lastSync = state.now;
+        state.now += state.readCost;                         // the read itself takes some time
+        runDue();
+        return &cyccntReg;
+    }
+
+    void disableIrq()
+    {
+        state.masked = true;
+    }
+
+    void enableIrq()
+    {
+        state.masked = false;
+        deliver();
+    }
+
+    bool inHandler()
+    {
+        return state.activePriority != 256;
+    }
+
+    bool irqEnabled()
+    {
+        return !state.masked;
+    }
+
+    void nvicEnable(unsigned irq, bool enable)
+    {
+        if (irq >= NVIC_NUM_INTERRUPTS) return;
+        state.enabled[irq] = enable;
+        if (enable) deliver();
+    }
+
+    void nvicSetPriority(unsigned irq, uint8_t priority)
+    {
+        if (irq < NVIC_NUM_INTERRUPTS) state.priority[irq] = priority;
+    }
+
+    void pinConfig(unsigned pin, int mode)
+    {
+        if (pin >= nrOfPins) return;
+        sync();
+
+        const Pin& p  = pins[pin];
+        uint32_t mask = 1UL << p.bit;
+
+        if (mode == OUTPUT || mode == OUTPUT_OPENDRAIN)
+            bank(p.port)[GDIR] |= mask;
+        else
+            bank(p.port)[GDIR] &= ~mask;
+
+        if (!(state.driven[p.port - 6] & mask)) // pull resistors define the level of undriven inputs
+        {
+            if (mode == INPUT_PULLUP)
+                state.ext[p.port - 6] |= mask;
+            else
+                state.ext[p.port - 6] &= ~mask;
+        }
+        updatePSR();
+    }
+
+    void pinInterrupt(unsigned pin, void (*isr)(), int mode)
+    {
+        if (pin >= nrOfPins) return;
+
+        const Pin& p  = pins[pin];
+        uint32_t mask = 1UL << p.bit;
+
+        bool wasEnabled = !state.masked;
+        disableIrq();
+        state.pinIsr[pin]     = isr;
+        state.pinIsrMode[pin] = mode;
+        if (isr)
+            bank(p.port)[IMR] |= mask;
+        else
+            bank(p.port)[IMR] &= ~mask;
+        bank(p.port)[ISR] &= ~mask;
+        if (wasEnabled) enableIrq();
+    }
+
+    uint32_t ldrex(volatile uint32_t* addr)
+    {
+        state.exclusive = addr;
+        return *addr;
+    }
+
+    uint32_t strex(uint32_t value, volatile uint32_t* addr)
+    {
+        if (state.exclusive != addr)
+        {
+            state.strexFailures++;
+            return 1;
+        }
+        *addr           = value;
+        state.exclusive = nullptr;
+        return 0;
+    }
+
+    void clrex()
+    {
+        state.exclusive = nullptr;
+    }
+
+    int timerStart(void (*isr)(), uint64_t periodCycles)
+    {
+        for (unsigned i = 0; i < 4; i++)
+        {
+            Timer& t = state.timers[i];
+            if (!t.active)
+            {
+                t = Timer{isr, periodCycles, state.now + periodCycles, true, false};
+                attachInterruptVector(IRQ_PIT, pitIsr);
+                NVIC_ENABLE_IRQ(IRQ_PIT);
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void timerStop(int channel)
+    {
+        if (channel < 0 || channel >= 4) return;
+        state.timers[channel].active = false;
+        state.timers[channel].flag   = false;
+    }
+} // namespace sim
+
+//===================================================================================
+// simulated core functions
+
+const struct digital_pin_bitband_and_config_table_struct digital_pin_to_info_PGM[] = {
+#define PIN(n) {&sim::gpio[sim::pins[n].port - 1][0], nullptr, nullptr, 1UL << sim::pins[n].bit}
+    PIN(0), PIN(1), PIN(2), PIN(3), PIN(4), PIN(5), PIN(6), PIN(7), PIN(8), PIN(9),
+    PIN(10), PIN(11), PIN(12), PIN(13), PIN(14), PIN(15), PIN(16), PIN(17), PIN(18), PIN(19),
+    PIN(20), PIN(21), PIN(22), PIN(23), PIN(24), PIN(25), PIN(26), PIN(27), PIN(28), PIN(29),
+    PIN(30), PIN(31), PIN(32), PIN(33), PIN(34), PIN(35), PIN(36), PIN(37), PIN(38), PIN(39),
+    PIN(40), PIN(41), PIN(42), PIN(43), PIN(44), PIN(45),
+#if !defined(ARDUINO_TEENSY_MICROMOD)
+    PIN(46), PIN(47), PIN(48), PIN(49), PIN(50), PIN(51), PIN(52), PIN(53), PIN(54),
+#endif
+#undef PIN
+};
+
+void attachInterruptVector(IRQ_NUMBER_t irq, void (*function)(void))
+{
+    _VectorsRam[irq + 16] = function;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    sim::pinConfig(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin >= CORE_NUM_DIGITAL) return;
+    if (val)
+        *portSetRegister(pin) = digitalPinToBitMask(pin);
+    else
+        *portClearRegister(pin) = digitalPinToBitMask(pin);
+    sim::sync();
+}
+
+uint8_t digitalRead(uint8_t pin)
+{
+    if (pin >= CORE_NUM_DIGITAL) return 0;
+    sim::sync();
+    return (*portInputRegister(pin) & digitalPinToBitMask(pin)) ? 1 : 0;
+}
+
+void digitalToggle(uint8_t pin)
+{
+    if (pin >= CORE_NUM_DIGITAL) return;
+    *portToggleRegister(pin) = digitalPinToBitMask(pin);
+    sim::sync();
+}
+
+void attachInterrupt(uint8_t pin, void (*function)(void), int mode)
+{
+    if (pin >= CORE_NUM_DIGITAL) return;
+    sim::pinInterrupt(pin, function, mode);
+    attachInterruptVector(IRQ_GPIO6789, sim::gpioIsr);
+    NVIC_ENABLE_IRQ(IRQ_GPIO6789);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    sim::pinInterrupt(pin, nullptr, 0);
+}
+
+uint32_t millis()
+{
+    return (uint32_t)(sim::cycles() / (F_CPU / 1000));
+}
+
+uint32_t micros()
+{
+    return (uint32_t)(sim::cycles() / (F_CPU / 1'000'000));
+}
+
+void delay(uint32_t msec)
+{
+    while (msec--)
+    {
+        sim::advance(F_CPU / 1000);
+        yield();
+    }
+}
+
+void delayMicroseconds(uint32_t usec)
+{
+    sim::advance((uint64_t)usec * (F_CPU / 1'000'000));
+}
+
+void delayNanoseconds(uint32_t nsec)
+{
+    sim::advance((uint64_t)nsec * (F_CPU / 1'000'000) / 1000);
+}
+
+__attribute__((weak)) void yield()
+{
+    static bool running = false;
+    if (running) return;
+    running = true;
+    EventResponder::runFromYield();
+    running = false;
+}
+
+unsigned long rtc_get()
+{
+    return sim::state.rtcBase + sim::state.rtcEdges;
+}
+
+void rtc_set(unsigned long t)
+{
+    sim::setRtc(t);
+}
+
+//===================================================================================
+// EventResponder, yield mode only
+
+EventResponder* EventResponder::firstYield = nullptr;
+EventResponder* EventResponder::lastYield  = nullptr;
+bool EventResponder::runningFromYield      = false;
+
+void EventResponder::triggerEvent(int status, void* data)
+{
+    _status = status;
+    _data   = data;
+
+    bool irq = sim::irqEnabled();
+    noInterrupts();
+    if (!_triggered)
+    {
+        _next = nullptr;
+        if (lastYield)
+            lastYield->_next = this;
+        else
+            firstYield = this;
+        lastYield  = this;
+        _triggered = true;
+    }
+    if (irq) interrupts();
+}
+
+void EventResponder::clearEvent()
+{
+    bool irq = sim::irqEnabled();
+    noInterrupts();
+    if (_triggered)
+    {
+        EventResponder** p = &firstYield;
+        EventResponder* prev = nullptr;
+        while (*p && *p != this)
+        {
+            prev = *p;
+            p    = &(*p)->_next;
+        }
+        if (*p) *p = _next;
+        if (lastYield == this) lastYield = prev;
+        _triggered = false;
+    }
+    if (irq) interrupts();
+}
+
+void EventResponder::runFromYield()
+{
+    if (!firstYield || runningFromYield) return;
+    runningFromYield = true;
+
+    bool irq = sim::irqEnabled();
+    noInterrupts();
+    EventResponder* first = firstYield;
+    firstYield            = first->_next;
+    if (!firstYield) lastYield = nullptr;
+    first->_triggered = false;
+    if (irq) interrupts();
+
+    if (first->_function) first->_function(*first);
+    runningFromYield = false;
+}
@@ -0,0 +1,66 @@
+#pragma once
+/************************************************************************************
+ * Control interface of the simulated Teensy 4.1 core
+ *
+ * The simulation is fully deterministic. Time only advances when the test code calls
+ * advance(), delay() is called or ARM_DWT_CYCCNT is read. Interrupts (IntervalTimer,
+ * 1Hz SNVS, pin interrupts or raise()) are delivered synchronously from these calls,
+ * in chronological order, and are postponed while interrupts are disabled. A handler is
+ * only preempted by interrupts with a higher priority (lower value, default 128).
+ *
+ * reset():             power on state: time 0, all pins low, no vectors, no timers
+ * cycles():            simulated time in CPU cycles since reset
+ * advance(cycles):     runs the simulated time forward and delivers all due interrupts
+ * setPin(pin, level):  drives an input pin from outside, edges trigger pin interrupts
+ * getPin(pin):         current level of the pin
+ * raise(irq):          pends the irq, it is delivered as soon as interrupts are enabled
+ * setReadCost(cycles): time each read of ARM_DWT_CYCCNT consumes (default 1 cycle)
+ * setRtc(secs):        sets the RTC seconds (rtc_get)
+ * setCrystalError(ppm): frequency error of the CPU clock relative to the RTC, e.g. +50:
+ *                      the cycle counter counts F_CPU * (1 + 50E-6) cycles per RTC second
+ * strexFailures():     number of failed strex() calls, i.e. exclusive accesses which were
+ *                      interrupted by a handler (see ldrex/strex below)
+ ************************************************************************************/
+
+#include <cstdint>
+
+namespace sim
+{
+    void reset();
+    uint64_t cycles();
+    void advance(uint64_t cycles);
+    void advanceMicros(double us);
+
+    void setPin(unsigned pin, bool level);
+    bool getPin(unsigned pin);
+
+    void raise(unsigned irq);
+    void setReadCost(uint32_t cycles);
+    void setRtc(uint32_t seconds);
+    void setCrystalError(double ppm);
+    uint32_t strexFailures();
+
+    // used by the core emulation ---------------------------------------------------
+    volatile uint32_t* gpioReg(unsigned port, unsigned index); // syncs the port before access
+    volatile uint32_t* reg(uintptr_t address);                // hard coded addresses of GPIO6..9 and IOMUXC_GPR_GPR26..29, aborts on others
+    volatile uint32_t* cycleCounter();                        // updates the counter before access
+    void sync();                                              // applies pending DR_SET/CLEAR/TOGGLE writes
+
+    void disableIrq();
+    void enableIrq();
+    bool irqEnabled();
+    bool inHandler(); // an interrupt handler is running (IPSR != 0)
+    void nvicEnable(unsigned irq, bool enable);
+    void nvicSetPriority(unsigned irq, uint8_t priority);
+
+    void pinConfig(unsigned pin, int mode);
+    void pinInterrupt(unsigned pin, void (*isr)(), int mode); // isr == nullptr: detach
+
+    // exclusive monitor: like on the Cortex-M7 the monitor is cleared on exception entry and return
+    uint32_t ldrex(volatile uint32_t* addr);
+    uint32_t strex(uint32_t value, volatile uint32_t* addr); // 0 on success
+    void clrex();
+
+    int timerStart(void (*isr)(), uint64_t periodCycles); // returns the channel or -1
+    void timerStop(int channel);
+}
@@ -0,0 +1,215 @@
+#pragma once
+/************************************************************************************
+ * Simulated IMXRT1062 registers, only the subset used by the helpers.
+ *
+ * GPIO registers are backed by memory with the same layout and bank distance (0x4000)
+ * as the real hardware, i.e. pointer arithmetic on digital_pin_to_info_PGM works.
+ * Writes to DR_SET/DR_CLEAR/DR_TOGGLE are applied at the next access through one of
+ * the register macros (or any other call into the simulation). Interrupt status
+ * registers (GPIOn_ISR, SNVS_HPSR) are acknowledged automatically when the isr returns.
+ ************************************************************************************/
+
+#include "hostSim.h"
+#include <cstdint>
+
+#define __IMXRT1062__ // compiler flags of the real toolchain, defined here so that sources which only include core_pins.h see them
+#define F_CPU 600000000
+#define F_CPU_ACTUAL F_CPU
+
+enum IRQ_NUMBER_t {
+    IRQ_SNVS_IRQ  = 46,
+    IRQ_PIT       = 122,
+    IRQ_GPIO6789  = 157,
+};
+#define NVIC_NUM_INTERRUPTS 160
+
+extern void (*_VectorsRam[NVIC_NUM_INTERRUPTS + 16])(void);
+void attachInterruptVector(IRQ_NUMBER_t irq, void (*function)(void));
+
+#define NVIC_ENABLE_IRQ(n)         sim::nvicEnable((n), true)
+#define NVIC_DISABLE_IRQ(n)        sim::nvicEnable((n), false)
+#define NVIC_SET_PRIORITY(irq, p)  sim::nvicSetPriority((irq), (p))
+#define NVIC_TRIGGER_IRQ(n)        sim::raise(n)
+
+#define __disable_irq() sim::disableIrq()
+#define __enable_irq()  sim::enableIrq()
+
+// DWT cycle counter -----------------------------------------------------------------
+
+extern volatile uint32_t simDebugRegs[2];
+#define ARM_DEMCR               simDebugRegs[0]
+#define ARM_DEMCR_TRCENA        (1 << 24)
+#define ARM_DWT_CTRL            simDebugRegs[1]
+#define ARM_DWT_CTRL_CYCCNTENA  (1 << 0)
+#define ARM_DWT_CYCCNT          (*sim::cycleCounter())
+
+// SNVS (RTC) ------------------------------------------------------------------------
+
+extern volatile uint32_t simSnvsRegs[2];
+#define SNVS_HPCR               simSnvsRegs[0]
+#define SNVS_HPSR               simSnvsRegs[1]
+#define SNVS_HPCR_PI_EN         ((uint32_t)(1 << 3))
+#define SNVS_HPCR_PI_FREQ(n)    ((uint32_t)(((n) & 0x0F) << 4))
+
+// IOMUXC GPR, routes the pins of GPIO1..4 to the fast GPIO6..9 -----------------------
+
+extern volatile uint32_t simGprRegs[4];
+#define IOMUXC_GPR_GPR26        simGprRegs[0]
+#define IOMUXC_GPR_GPR27        simGprRegs[1]
+#define IOMUXC_GPR_GPR28        simGprRegs[2]
+#define IOMUXC_GPR_GPR29        simGprRegs[3]
+
+// CCM clock gates -------------------------------------------------------------------
+
+extern volatile uint32_t simCcmRegs[2];
+#define CCM_CCGR1               simCcmRegs[0]
+#define CCM_CCGR2               simCcmRegs[1]
+#define CCM_CCGR_ON             3
+#define CCM_CCGR1_PIT(n)        ((uint32_t)(((n) & 0x03) << 12))
+#define CCM_CCGR2_XBAR1(n)      ((uint32_t)(((n) & 0x03) << 22))
+
+// PIT, registers only. The channels run at 24MHz, only their DMA trigger (routed through
+// XBAR1 to a DMAChannel) is simulated. IntervalTimer uses sim::timerStart instead.
+
+typedef struct
+{
+    volatile uint32_t LDVAL;
+    volatile uint32_t CVAL;
+    volatile uint32_t TCTRL;
+    volatile uint32_t TFLG;
+} IMXRT_PIT_CHANNEL_t;
+
+extern volatile uint32_t simPitMcr;
+extern IMXRT_PIT_CHANNEL_t simPitChannels[4];
+#define PIT_MCR                 simPitMcr
+#define IMXRT_PIT_CHANNELS      simPitChannels
+#define PIT_TCTRL_TEN           ((uint32_t)(1 << 0))
+#define PIT_TCTRL_TIE           ((uint32_t)(1 << 1))
+
+// XBAR1 (16 bit registers SEL0..SEL65, CTRL0, CTRL1) and the DMA request sources --------
+
+extern volatile uint16_t simXbarRegs[68];
+#define XBARA1_SEL0             simXbarRegs[0]
+#define XBARA1_CTRL0            simXbarRegs[66]
+#define XBARA1_CTRL1            simXbarRegs[67]
+#define XBARA_CTRL_DEN0         ((uint16_t)(1 << 0))
+#define XBARA_CTRL_EDGE0(n)     ((uint16_t)(((n) & 0x03) << 2))
+#define XBARA_CTRL_STS0         ((uint16_t)(1 << 4))
+
+#define XBARA1_IN_PIT_TRIGGER0       56
+#define XBARA1_IN_PIT_TRIGGER1       57
+#define XBARA1_IN_PIT_TRIGGER2       58
+#define XBARA1_IN_PIT_TRIGGER3       59
+#define XBARA1_OUT_DMA_CH_MUX_REQ30  118
+
+#define DMAMUX_SOURCE_XBAR1_0        30
+
+// GPIO ------------------------------------------------------------------------------
+
+#define GPIO1_DR        (*sim::gpioReg(1, 0))
+#define GPIO1_GDIR      (*sim::gpioReg(1, 1))
+#define GPIO1_PSR       (*sim::gpioReg(1, 2))
+#define GPIO1_ICR1      (*sim::gpioReg(1, 3))
+#define GPIO1_ICR2      (*sim::gpioReg(1, 4))
+#define GPIO1_IMR       (*sim::gpioReg(1, 5))
+#define GPIO1_ISR       (*sim::gpioReg(1, 6))
+#define GPIO1_EDGE_SEL  (*sim::gpioReg(1, 7))
+#define GPIO1_DR_SET    (*sim::gpioReg(1, 33))
+#define GPIO1_DR_CLEAR  (*sim::gpioReg(1, 34))
+#define GPIO1_DR_TOGGLE (*sim::gpioReg(1, 35))
+
+#define GPIO2_DR        (*sim::gpioReg(2, 0))
+#define GPIO2_GDIR      (*sim::gpioReg(2, 1))
+#define GPIO2_PSR       (*sim::gpioReg(2, 2))
+#define GPIO2_ICR1      (*sim::gpioReg(2, 3))
+#define GPIO2_ICR2      (*sim::gpioReg(2, 4))
+#define GPIO2_IMR       (*sim::gpioReg(2, 5))
+#define GPIO2_ISR       (*sim::gpioReg(2, 6))
+#define GPIO2_EDGE_SEL  (*sim::gpioReg(2, 7))
+#define GPIO2_DR_SET    (*sim::gpioReg(2, 33))
+#define GPIO2_DR_CLEAR  (*sim::gpioReg(2, 34))
+#define GPIO2_DR_TOGGLE (*sim::gpioReg(2, 35))
+
+#define GPIO3_DR        (*sim::gpioReg(3, 0))
+#define GPIO3_GDIR      (*sim::gpioReg(3, 1))
+#define GPIO3_PSR       (*sim::gpioReg(3, 2))
+#define GPIO3_ICR1      (*sim::gpioReg(3, 3))
+#define GPIO3_ICR2      (*sim::gpioReg(3, 4))
+#define GPIO3_IMR       (*sim::gpioReg(3, 5))
+#define GPIO3_ISR       (*sim::gpioReg(3, 6))
+#define GPIO3_EDGE_SEL  (*sim::gpioReg(3, 7))
+#define GPIO3_DR_SET    (*sim::gpioReg(3, 33))
+#define GPIO3_DR_CLEAR  (*sim::gpioReg(3, 34))
+#define GPIO3_DR_TOGGLE (*sim::gpioReg(3, 35))
+
+#define GPIO4_DR        (*sim::gpioReg(4, 0))
+#define GPIO4_GDIR      (*sim::gpioReg(4, 1))
+#define GPIO4_PSR       (*sim::gpioReg(4, 2))
+#define GPIO4_ICR1      (*sim::gpioReg(4, 3))
+#define GPIO4_ICR2      (*sim::gpioReg(4, 4))
+#define GPIO4_IMR       (*sim::gpioReg(4, 5))
+#define GPIO4_ISR       (*sim::gpioReg(4, 6))
+#define GPIO4_EDGE_SEL  (*sim::gpioReg(4, 7))
+#define GPIO4_DR_SET    (*sim::gpioReg(4, 33))
+#define GPIO4_DR_CLEAR  (*sim::gpioReg(4, 34))
+#define GPIO4_DR_TOGGLE (*sim::gpioReg(4, 35))
+
+#define GPIO5_DR        (*sim::gpioReg(5, 0))
+#define GPIO5_GDIR      (*sim::gpioReg(5, 1))
+#define GPIO5_PSR       (*sim::gpioReg(5, 2))
+#define GPIO5_ICR1      (*sim::gpioReg(5, 3))
+#define GPIO5_ICR2      (*sim::gpioReg(5, 4))
+#define GPIO5_IMR       (*sim::gpioReg(5, 5))
+#define GPIO5_ISR       (*sim::gpioReg(5, 6))
+#define GPIO5_EDGE_SEL  (*sim::gpioReg(5, 7))
+#define GPIO5_DR_SET    (*sim::gpioReg(5, 33))
+#define GPIO5_DR_CLEAR  (*sim::gpioReg(5, 34))
+#define GPIO5_DR_TOGGLE (*sim::gpioReg(5, 35))
+
+#define GPIO6_DR        (*sim::gpioReg(6, 0))
+#define GPIO6_GDIR      (*sim::gpioReg(6, 1))
+#define GPIO6_PSR       (*sim::gpioReg(6, 2))
+#define GPIO6_ICR1      (*sim::gpioReg(6, 3))
+#define GPIO6_ICR2      (*sim::gpioReg(6, 4))
+#define GPIO6_IMR       (*sim::gpioReg(6, 5))
+#define GPIO6_ISR       (*sim::gpioReg(6, 6))
+#define GPIO6_EDGE_SEL  (*sim::gpioReg(6, 7))
+#define GPIO6_DR_SET    (*sim::gpioReg(6, 33))
+#define GPIO6_DR_CLEAR  (*sim::gpioReg(6, 34))
+#define GPIO6_DR_TOGGLE (*sim::gpioReg(6, 35))
+
+#define GPIO7_DR        (*sim::gpioReg(7, 0))
+#define GPIO7_GDIR      (*sim::gpioReg(7, 1))
+#define GPIO7_PSR       (*sim::gpioReg(7, 2))
+#define GPIO7_ICR1      (*sim::gpioReg(7, 3))
+#define GPIO7_ICR2      (*sim::gpioReg(7, 4))
+#define GPIO7_IMR       (*sim::gpioReg(7, 5))
+#define GPIO7_ISR       (*sim::gpioReg(7, 6))
+#define GPIO7_EDGE_SEL  (*sim::gpioReg(7, 7))
+#define GPIO7_DR_SET    (*sim::gpioReg(7, 33))
+#define GPIO7_DR_CLEAR  (*sim::gpioReg(7, 34))
+#define GPIO7_DR_TOGGLE (*sim::gpioReg(7, 35))
+
+#define GPIO8_DR        (*sim::gpioReg(8, 0))
+#define GPIO8_GDIR      (*sim::gpioReg(8, 1))
+#define GPIO8_PSR       (*sim::gpioReg(8, 2))
+#define GPIO8_ICR1      (*sim::gpioReg(8, 3))
+#define GPIO8_ICR2      (*sim::gpioReg(8, 4))
+#define GPIO8_IMR       (*sim::gpioReg(8, 5))
+#define GPIO8_ISR       (*sim::gpioReg(8, 6))
+#define GPIO8_EDGE_SEL  (*sim::gpioReg(8, 7))
+#define GPIO8_DR_SET    (*sim::gpioReg(8, 33))
+#define GPIO8_DR_CLEAR  (*sim::gpioReg(8, 34))
+#define GPIO8_DR_TOGGLE (*sim::gpioReg(8, 35))
+
+#define GPIO9_DR        (*sim::gpioReg(9, 0))
+#define GPIO9_GDIR      (*sim::gpioReg(9, 1))
+#define GPIO9_PSR       (*sim::gpioReg(9, 2))
+#define GPIO9_ICR1      (*sim::gpioReg(9, 3))
+#define GPIO9_ICR2      (*sim::gpioReg(9, 4))
+#define GPIO9_IMR       (*sim::gpioReg(9, 5))
+#define GPIO9_ISR       (*sim::gpioReg(9, 6))
+#define GPIO9_EDGE_SEL  (*sim::gpioReg(9, 7))
+#define GPIO9_DR_SET    (*sim::gpioReg(9, 33))
+#define GPIO9_DR_CLEAR  (*sim::gpioReg(9, 34))
+#define GPIO9_DR_TOGGLE (*sim::gpioReg(9, 35))
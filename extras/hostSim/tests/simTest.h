@@ -0,0 +1,44 @@
+#pragma once
+/************************************************************************************
+ * Minimal checks for the host tests. A test is a normal program, it prints the failed
+ * checks and returns the number of failures from main:
+ *
+ *   int main()
+ *   {
+ *       CHECK(x == 1);
+ *       CHECK_EQ(millis(), 100u);
+ *       return simTest::result();
+ *   }
+ ************************************************************************************/
+
+#include <cstdio>
+
+namespace simTest
+{
+    inline int failures = 0;
+
+    inline bool check(bool ok, const char* expr, const char* file, int line)
+    {
+        if (!ok)
+        {
+            printf("%s:%d: check failed: %s\n", file, line, expr);
+            failures++;
+        }
+        return ok;
+    }
+
+    inline int result()
+    {
+        if (failures) printf("%d check(s) failed\n", failures);
+        return failures ? 1 : 0;
+    }
+}
+
+#define CHECK(cond) simTest::check((cond), #cond, __FILE__, __LINE__)
+#define CHECK_EQ(a, b)                                                                        \
+    do {                                                                                      \
+        auto va = (a);                                                                        \
+        auto vb = (b);                                                                        \
+        if (!simTest::check(va == vb, #a " == " #b, __FILE__, __LINE__))                      \
+            printf("    %lld != %lld\n", (long long)va, (long long)vb);                        \
+    } while (0)
@@ -0,0 +1,165 @@
+// TimerWheel: expiry at the exact tick over all levels, periodic timers, timers which
+// re-arm, cancel or destroy themselves from their callback and a higher priority ISR
+// which modifies the expired list while tick() runs.
+
+#include "Arduino.h"
+#include "TimerWheel.h"
+#include "simTest.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr IRQ_NUMBER_t IRQ_TEST = (IRQ_NUMBER_t)20;
+
+    TimerWheel wheel;
+
+    void advanceTicks(uint32_t n) { sim::advance((uint64_t)n * (F_CPU / 1000)); }
+
+    // sets its flag when destroyed, i.e. when the std::function holding it is destroyed
+    struct Guard
+    {
+        bool* destroyed;
+        Guard(bool* d) : destroyed(d) {}
+        Guard(const Guard& o) : destroyed(o.destroyed) {}
+        ~Guard() { *destroyed = true; }
+    };
+}
+
+int main()
+{
+    sim::reset();
+    CHECK(wheel.begin(1ms));
+
+    // one shot timers fire exactly at the requested tick, including the cascaded levels 1..3
+    // (inside a callback ticks() already includes the tick which fired the timer)
+    for (uint32_t delay : {1u, 50u, 64u, 65u, 5'000u, 300'000u})
+    {
+        TimerWheel::Timer t;
+        uint32_t firedAt = 0;
+        uint32_t start   = wheel.ticks();
+        wheel.start(t, [&] { firedAt = wheel.ticks(); }, std::chrono::milliseconds(delay));
+        advanceTicks(delay + 2);
+        CHECK_EQ(firedAt - start, delay + 1);
+        CHECK(!t.isActive());
+    }
+
+    // periodic
+    {
+        TimerWheel::Timer t;
+        int n = 0;
+        wheel.startPeriodic(t, [&] { n++; }, 10ms);
+        advanceTicks(1001); // started right after a tick -> first call after 11 ticks
+        CHECK_EQ(n, 100);
+        wheel.cancel(t);
+        advanceTicks(100);
+        CHECK_EQ(n, 100);
+    }
+
+    // a callback which re-arms its own timer with a new callback must not destroy itself while running
+    {
+        TimerWheel::Timer t;
+        bool firstDestroyed = false, secondDestroyed = false, aliveAfterRearm = false;
+        int second = 0;
+
+        Guard g1(&firstDestroyed);
+        firstDestroyed = false;
+        wheel.start(t, [&, g1] {
+            Guard g2(&secondDestroyed);
+            wheel.start(t, [&, g2] { second++; }, 5ms);
+            aliveAfterRearm = !firstDestroyed; // captures of the running callback are still valid
+        }, 5ms);
+        firstDestroyed = false;
+
+        advanceTicks(6);
+        CHECK(aliveAfterRearm);
+        CHECK(firstDestroyed); // released after the callback returned
+        advanceTicks(6);
+        CHECK_EQ(second, 1);
+    }
+
+    // a periodic timer which cancels itself keeps working after a restart
+    {
+        TimerWheel::Timer t;
+        int n = 0;
+        wheel.startPeriodic(t, [&] { if (++n == 3) wheel.cancel(t); }, 2ms);
+        advanceTicks(20);
+        CHECK_EQ(n, 3);
+        CHECK(!t.isActive());
+    }
+
+    // a timer destroyed from its own callback
+    {
+        auto* t  = new TimerWheel::Timer;
+        int n    = 0;
+        wheel.startPeriodic(*t, [&] { n++; delete t; }, 3ms);
+        advanceTicks(20);
+        CHECK_EQ(n, 1);
+    }
+
+    // a callback cancels a timer which expires in the same tick
+    {
+        TimerWheel::Timer a, b;
+        int na = 0, nb = 0;
+        wheel.start(a, [&] { na++; wheel.cancel(b); }, 7ms);
+        wheel.start(b, [&] { nb++; }, 7ms);
+        advanceTicks(10);
+        CHECK_EQ(na, 1);
+        CHECK_EQ(nb, 0);
+    }
+
+    // a higher priority ISR cancels, restarts and destroys timers while tick() runs
+    {
+        static TimerWheel::Timer *a, *b, *c;
+        static int na, nb, nc, nIsr;
+        a = new TimerWheel::Timer;
+        b = new TimerWheel::Timer;
+        c = new TimerWheel::Timer;
+        na = nb = nc = nIsr = 0;
+
+        attachInterruptVector(IRQ_TEST, [] {
+            nIsr++;
+            wheel.cancel(*b);                          // b is in the expired list
+            wheel.start(*a, [] { na += 10; }, 4ms);    // a is running
+            delete c;                                  // c is in the expired list
+            c = nullptr;
+        });
+        NVIC_SET_PRIORITY(IRQ_TEST, 32);
+        NVIC_ENABLE_IRQ(IRQ_TEST);
+
+        wheel.start(*a, [] { na++; NVIC_TRIGGER_IRQ(IRQ_TEST); }, 3ms);
+        wheel.start(*b, [] { nb++; }, 3ms);
+        wheel.start(*c, [] { nc++; }, 3ms);
+        advanceTicks(5);
+        CHECK_EQ(nIsr, 1);
+        CHECK_EQ(na, 1);
+        CHECK_EQ(nb, 0);
+        CHECK_EQ(nc, 0);
+        advanceTicks(5);
+        CHECK_EQ(na, 11);
+
+        NVIC_DISABLE_IRQ(IRQ_TEST);
+        delete a;
+        delete b;
+    }
+
+    // many timers in all levels
+    {
+        constexpr unsigned n = 1000;
+        static TimerWheel::Timer timers[n];
+        static uint32_t expected[n], firedAt[n];
+        uint32_t start = wheel.ticks();
+        for (unsigned i = 0; i < n; i++)
+        {
+            expected[i] = 1 + (i * 7919u) % 20'000u;
+            wheel.start(timers[i], [i] { firedAt[i] = wheel.ticks(); }, std::chrono::milliseconds(expected[i]));
+        }
+        advanceTicks(20'002);
+        unsigned wrong = 0;
+        for (unsigned i = 0; i < n; i++) wrong += firedAt[i] - start != expected[i] + 1;
+        CHECK_EQ(wrong, 0u);
+    }
+
+    wheel.end();
+    return simTest::result();
+}
@@ -0,0 +1,113 @@
+// YieldScheduler: priorities, call intervals, interval limit, task list changes from running tasks
+// and from interrupts, diagnostic budget
+
+#include "Arduino.h"
+#include "attachYieldFunc.h"
+#include "simTest.h"
+
+namespace
+{
+    int order[3], nrCalls, slowCalls, addResult = -1, removeResult;
+    int selfId;
+
+    void low() { order[nrCalls++ % 3] = 0; }
+    void mid() { order[nrCalls++ % 3] = 1; }
+    void high() { order[nrCalls++ % 3] = 2; }
+    void slow() { slowCalls++; }
+    void adder() { addResult = YieldScheduler::addTask(slow); }
+    void remover() { removeResult = YieldScheduler::removeTask(selfId); }
+
+    // interrupt which removes the next task while the scheduler runs
+    constexpr unsigned IRQ_TEST = 100;
+    int victimId, victimCalls, isrAddResult;
+    void victim() { victimCalls++; }
+    void trigger() { NVIC_TRIGGER_IRQ(IRQ_TEST); }
+    void isrRemove() { YieldScheduler::removeTask(victimId); }
+    void isrAdd() { isrAddResult = YieldScheduler::addTask(slow); }
+
+    void run(double seconds)
+    {
+        uint64_t end = sim::cycles() + (uint64_t)(seconds * F_CPU);
+        while (sim::cycles() < end)
+        {
+            yield();
+            sim::advance(F_CPU / 10'000); // 100µs per loop
+        }
+    }
+}
+
+int main()
+{
+    sim::reset();
+
+    int idLow  = YieldScheduler::addTask(low, 0);
+    int idHigh = YieldScheduler::addTask(high, 10);
+    int idMid  = YieldScheduler::addTask(mid, 5);
+    CHECK(idLow > 0 && idMid > 0 && idHigh > 0);
+    yield();
+    CHECK_EQ(order[0], 2);
+    CHECK_EQ(order[1], 1);
+    CHECK_EQ(order[2], 0);
+    YieldScheduler::removeTask(idLow);
+    YieldScheduler::removeTask(idMid);
+    YieldScheduler::removeTask(idHigh);
+
+    // intervals above 2^32 cycles can't be measured with the cycle counter
+    CHECK_EQ(YieldScheduler::addTask(slow, 0, 7'200'000), 0);
+    int idSlow = YieldScheduler::addTask(slow, 0, 7'000'000);
+    CHECK(idSlow > 0);
+    run(15);
+    CHECK_EQ(slowCalls, 3); // t = 0, 7s, 14s
+    YieldScheduler::removeTask(idSlow);
+
+    // adding from a running task is refused, removing works
+    int idAdder = YieldScheduler::addTask(adder);
+    yield();
+    CHECK_EQ(addResult, 0);
+    YieldScheduler::removeTask(idAdder);
+
+    selfId = YieldScheduler::addTask(remover);
+    yield();
+    CHECK_EQ(removeResult, 1);
+    YieldScheduler::TaskStats stats;
+    CHECK(!YieldScheduler::getStats(selfId, stats));
+
+    // removing from an interrupt while the scheduler runs: the removed task isn't called anymore
+    attachInterruptVector((IRQ_NUMBER_t)IRQ_TEST, isrRemove);
+    NVIC_ENABLE_IRQ(IRQ_TEST);
+    int idTrigger = YieldScheduler::addTask(trigger, 1); // runs first, the isr is delivered before the victim
+    victimId      = YieldScheduler::addTask(victim, 0);
+    yield();
+    CHECK_EQ(victimCalls, 0);
+    CHECK(!YieldScheduler::getStats(victimId, stats));
+    YieldScheduler::removeTask(idTrigger);
+
+    // adding from an interrupt is refused while the scheduler runs, works otherwise
+    attachInterruptVector((IRQ_NUMBER_t)IRQ_TEST, isrAdd);
+    idTrigger = YieldScheduler::addTask(trigger);
+    yield();
+    CHECK_EQ(isrAddResult, 0);
+    YieldScheduler::removeTask(idTrigger);
+    NVIC_TRIGGER_IRQ(IRQ_TEST);
+    sim::advance(1);
+    CHECK(isrAddResult > 0);
+    CHECK(YieldScheduler::removeTask(isrAddResult));
+
+    // both keep a critical section of the caller
+    noInterrupts();
+    int id = YieldScheduler::addTask(slow);
+    CHECK(!sim::irqEnabled());
+    YieldScheduler::removeTask(id);
+    CHECK(!sim::irqEnabled());
+    interrupts();
+
+    // the budget is diagnostic only, overrunning tasks are still called
+    static int overrunCalls;
+    id = YieldScheduler::addTask([] { overrunCalls++; sim::advance(1000); }, 0, 0, 100);
+    for (int i = 0; i < 5; i++) yield();
+    CHECK(YieldScheduler::getStats(id, stats));
+    CHECK_EQ(overrunCalls, 5);
+    CHECK_EQ(stats.overruns, 5u);
+
+    return simTest::result();
+}
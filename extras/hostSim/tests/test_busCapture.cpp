@@ -0,0 +1,108 @@
+// BusCapture: trigger timeout derived from the sample rate, blocked captures limited to
+// maxBlockedCycles (by the number of samples and if the loop can't keep up), maxSampleRate
+// captures without overruns at the reported rate but not above
+
+#include "Arduino.h"
+#include "BusCapture.h"
+#include "hostSim.h"
+#include "simTest.h"
+
+using MMT::BusCapture;
+using MMT::CaptureConfig;
+
+namespace
+{
+    uint32_t buffer[1024];
+
+    CaptureConfig waitForTrigger(float sampleRate, float timeout, bool blockInterrupts)
+    {
+        CaptureConfig cfg;
+        cfg.sampleRate      = sampleRate;
+        cfg.rle             = false;
+        cfg.samples         = 10;
+        cfg.triggerMask     = 0x01; // G0 stays low, i.e. the capture times out
+        cfg.triggerValue    = 0x01;
+        cfg.timeout         = timeout;
+        cfg.blockInterrupts = blockInterrupts;
+        return cfg;
+    }
+
+    void testTimeout()
+    {
+        sim::reset();
+        sim::setReadCost(1000); // keeps the number of simulated wait loops small
+
+        BusCapture cap(buffer);
+        CHECK(!cap.capture(waitForTrigger(10E3, 0.01f, true)));
+        CHECK_EQ(cap.samples(), 100u); // 10ms @ 10kHz
+        CHECK_EQ(cap.triggerSample(), -1);
+    }
+
+    void testBlockedLimit()
+    {
+        sim::reset();
+        sim::setReadCost(1000);
+
+        BusCapture cap(buffer);
+        uint64_t t0 = sim::cycles();
+        CHECK(!cap.capture(waitForTrigger(1E3, 10, true))); // 10s with interrupts disabled would break cycles64
+        uint64_t blocked = sim::cycles() - t0;
+
+        CHECK_EQ(cap.samples(), BusCapture::maxBlockedCycles / cap.period() - 10);
+        CHECK(blocked <= BusCapture::maxBlockedCycles + 2 * cap.period());
+
+        CHECK(!cap.capture(waitForTrigger(1E3, 3, false))); // interrupts enabled, no limit
+        CHECK_EQ(cap.samples(), 3000u);
+    }
+
+    void testCantKeepUp()
+    {
+        sim::reset();
+        sim::setReadCost(1'000'000); // each sample is late
+
+        CaptureConfig cfg;
+        cfg.sampleRate = 1E6;
+        cfg.samples    = 1'000'000;
+
+        BusCapture cap(buffer);
+        uint64_t t0 = sim::cycles();
+        cap.capture(cfg);
+        uint64_t blocked = sim::cycles() - t0;
+
+        CHECK(cap.overruns() > 0);
+        CHECK(cap.samples() < 1'000'000u);
+        CHECK(blocked <= BusCapture::maxBlockedCycles + 10'000'000);
+    }
+
+    void testMaxSampleRate(bool rle)
+    {
+        sim::reset();
+        sim::setReadCost(3); // the loop reads the cycle counter several times per sample
+
+        float rate = BusCapture::maxSampleRate(rle);
+        CHECK(rate > 0);
+
+        CaptureConfig cfg;
+        cfg.rle        = rle;
+        cfg.samples    = 2000;
+        cfg.sampleRate = rate;
+
+        BusCapture cap(buffer);
+        cap.capture(cfg);
+        CHECK_EQ(cap.overruns(), 0u);
+
+        cfg.sampleRate = (float)F_CPU / (cap.period() - 1); // one cycle less per sample
+        cap.capture(cfg);
+        CHECK(cap.overruns() > 0);
+    }
+}
+
+int main()
+{
+    testTimeout();
+    testBlockedLimit();
+    testCantKeepUp();
+    testMaxSampleRate(false);
+    testMaxSampleRate(true);
+    return simTest::result();
+}
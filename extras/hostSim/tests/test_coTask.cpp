@@ -0,0 +1,85 @@
+// CoTask pin_edge: several waiters on one pin, waiters with a conflicting edge mode and
+// pins with an interrupt attached by other code are refused and counted
+
+#include "Arduino.h"
+#include "attachInterruptEx.h"
+#include "coTask.h"
+#include "simTest.h"
+
+namespace
+{
+    int edges[3];
+    int results[3]; // 0: waiting, 1: edge, -1: refused
+
+    CoTask::Task edgeWaiter(unsigned id, uint8_t pin, int mode)
+    {
+        results[id] = co_await CoTask::pin_edge(pin, mode) ? 1 : -1;
+        if (results[id] == 1) edges[id]++;
+    }
+
+    void reset()
+    {
+        for (int& e : edges) e = 0;
+        for (int& r : results) r = 0;
+    }
+
+    bool attached(uint8_t pin) { return digital_pin_to_info_PGM[pin].reg[5] & digital_pin_to_info_PGM[pin].mask; }
+}
+
+int main()
+{
+    pinMode(2, INPUT);
+    pinMode(3, INPUT);
+    CoTask::begin();
+
+    // two waiters with the same mode share the pin interrupt, both are woken
+    reset();
+    CoTask::start(edgeWaiter(0, 2, RISING));
+    CoTask::start(edgeWaiter(1, 2, RISING));
+    yield();
+    CHECK(attached(2));
+    sim::setPin(2, 1);
+    yield();
+    CHECK_EQ(results[0], 1);
+    CHECK_EQ(results[1], 1);
+    CHECK(!attached(2)); // released after the last waiter
+    CHECK_EQ(CoTask::getStats().pinWaitFailures, 0u);
+
+    // a second waiter for another edge on the same pin is refused, the first one keeps its mode
+    reset();
+    sim::setPin(2, 0);
+    CoTask::start(edgeWaiter(0, 2, RISING));
+    CoTask::start(edgeWaiter(1, 2, FALLING));
+    yield();
+    CHECK_EQ(results[1], -1);
+    CHECK_EQ(CoTask::getStats().pinWaitFailures, 1u);
+    sim::setPin(2, 1);
+    yield();
+    CHECK_EQ(results[0], 1);
+    CHECK(!attached(2));
+
+    // pin interrupt attached by other code: refused, the foreign callback stays attached
+    reset();
+    int foreign = 0;
+    attachInterruptEx(3, [&] { foreign++; }, CHANGE);
+    CoTask::start(edgeWaiter(2, 3, CHANGE));
+    yield();
+    CHECK_EQ(results[2], -1);
+    CHECK_EQ(CoTask::getStats().pinWaitFailures, 2u);
+    sim::setPin(3, 1);
+    CHECK_EQ(foreign, 1);
+    CHECK(attached(3));
+
+    // after the owner detached, the pin can be awaited
+    detachInterrupt(3);
+    reset();
+    CoTask::start(edgeWaiter(2, 3, CHANGE));
+    yield();
+    CHECK_EQ(results[2], 0);
+    sim::setPin(3, 0);
+    yield();
+    CHECK_EQ(results[2], 1);
+    CHECK_EQ(foreign, 1);
+
+    return simTest::result();
+}
@@ -0,0 +1,117 @@
+// CycleProfiler: count/min/max/mean, histogram bucketing, the probe overhead before and
+// after begin() and the site list, including sites which are hit first from an interrupt
+
+#include "Arduino.h"
+#include "cycleProfiler.h"
+#include "simTest.h"
+#include <string>
+
+namespace
+{
+    constexpr unsigned IRQ_TEST = 100;
+
+    struct StringStream : Stream
+    {
+        std::string text;
+
+        size_t write(uint8_t b) override
+        {
+            text += (char)b;
+            return 1;
+        }
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+    };
+
+    void section(uint32_t cycles)
+    {
+        PROFILE_BEGIN(section, "section");
+        sim::advance(cycles);
+        PROFILE_END(section);
+    }
+
+    void isr()
+    {
+        PROFILE_SCOPE("isr");
+        sim::advance(50);
+    }
+
+    unsigned nrOfSites()
+    {
+        unsigned n = 0;
+        for (CycleProfiler::Site* s = CycleProfiler::sites(); s != nullptr; s = s->next) n++;
+        return n;
+    }
+
+    bool listed(const CycleProfiler::Site* site)
+    {
+        for (CycleProfiler::Site* s = CycleProfiler::sites(); s != nullptr; s = s->next)
+        {
+            if (s == site) return true;
+        }
+        return false;
+    }
+}
+
+int main()
+{
+    // before begin() nothing is subtracted, the probe overhead (one CYCCNT read) is included
+    CHECK(CycleProfiler::sites() == nullptr);
+    section(100);
+    CHECK_EQ(nrOfSites(), 1u);
+    CycleProfiler::Site* sectionSite = CycleProfiler::sites();
+    CHECK_EQ(sectionSite->count, 1u);
+    CHECK_EQ(sectionSite->max, 101u);
+
+    StringStream out;
+    CycleProfiler::begin(out);
+    CHECK_EQ(CycleProfiler::overhead(), 1u);
+    CHECK_EQ(nrOfSites(), 1u); // the calibration site isn't listed
+
+    // count, min, max, mean
+    CycleProfiler::reset();
+    CHECK_EQ(sectionSite->count, 0u);
+    for (uint32_t c : {10u, 200u, 30u}) section(c);
+    CHECK_EQ(sectionSite->count, 3u);
+    CHECK_EQ(sectionSite->min, 10u);
+    CHECK_EQ(sectionSite->max, 200u);
+    CHECK_EQ(sectionSite->sum, 240u);
+    CHECK_EQ(sectionSite->histogram[3], 1u); // 10:  [8, 16)
+    CHECK_EQ(sectionSite->histogram[4], 1u); // 30:  [16, 32)
+    CHECK_EQ(sectionSite->histogram[7], 1u); // 200: [128, 256)
+
+    // bucketing at the limits, record() subtracts the probe overhead
+    static CycleProfiler::Site limits("limits");
+    uint32_t o = CycleProfiler::overhead();
+    for (uint32_t c : {0u, 1u, 2u, 3u, 4u, 127u, 128u, 0x8000'0000u, UINT32_MAX - o}) limits.record(c + o);
+    limits.record(0); // shorter than the overhead -> 0
+    CHECK_EQ(limits.count, 10u);
+    CHECK_EQ(limits.min, 0u);
+    CHECK_EQ(limits.max, UINT32_MAX - o);
+    CHECK_EQ(limits.histogram[0], 3u); // 0, 1 and the clamped one
+    CHECK_EQ(limits.histogram[1], 2u); // 2, 3
+    CHECK_EQ(limits.histogram[2], 1u);
+    CHECK_EQ(limits.histogram[6], 1u);
+    CHECK_EQ(limits.histogram[7], 1u);
+    CHECK_EQ(limits.histogram[31], 2u);
+
+    // site list: newest first, each site once, sites hit first from an interrupt are listed too
+    CHECK(CycleProfiler::sites() == &limits);
+    CHECK_EQ(nrOfSites(), 2u);
+    attachInterruptVector((IRQ_NUMBER_t)IRQ_TEST, isr);
+    NVIC_ENABLE_IRQ(IRQ_TEST);
+    NVIC_TRIGGER_IRQ(IRQ_TEST);
+    NVIC_TRIGGER_IRQ(IRQ_TEST);
+    CHECK_EQ(nrOfSites(), 3u);
+    CHECK_EQ(CycleProfiler::sites()->count, 2u);
+    CHECK_EQ(CycleProfiler::sites()->min, 50u);
+    CHECK(listed(sectionSite) && listed(&limits));
+
+    CycleProfiler::report();
+    CHECK(out.text.find("section") != std::string::npos);
+    CHECK(out.text.find("isr") != std::string::npos);
+    CHECK(out.text.find("calibration") == std::string::npos);
+
+    return simTest::result();
+}
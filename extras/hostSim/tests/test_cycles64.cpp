@@ -0,0 +1,73 @@
+// cycles64: extension over many counter overflows, the 2^31 cycle limit without the RTC
+// interrupt and the LDREX/STREX retry path under heavy interrupt load
+
+#include "Arduino.h"
+#include "IntervalTimer.h"
+#include "cycles64.h"
+#include "simTest.h"
+
+namespace
+{
+    volatile uint64_t lastIsr;
+    volatile unsigned isrErrors;
+
+    void isr()
+    {
+        uint64_t now = cycles64::get();
+        if (now < lastIsr) isrErrors = isrErrors + 1;
+        lastIsr = now;
+    }
+
+    // cycles64 follows the simulated time (a 64bit counter) with a constant offset.
+    // The offset changes if the extension misses an overflow
+    int64_t offset;
+
+    int64_t currentOffset() { return (int64_t)(sim::cycles() - cycles64::get()); }
+    bool tracks() { return currentOffset() - offset < 1000; }
+}
+
+int main()
+{
+    sim::reset();
+    offset = currentOffset();
+
+    // without the RTC interrupt: one call per 3.4s (< 2^31 cycles) is enough
+    for (int i = 0; i < 20; i++)
+    {
+        sim::advance((uint64_t)(3.4 * F_CPU));
+        CHECK(tracks());
+    }
+
+    // ...a gap of more than 2^31 cycles breaks the extension (documented limit)
+    sim::advance((uint64_t)(3.7 * F_CPU));
+    CHECK(!tracks());
+
+    // with the RTC interrupt any gap is fine
+    offset = currentOffset();
+    cycles64::begin();
+    sim::advance(60ull * F_CPU);
+    CHECK(tracks());
+
+    // high frequency ISR reading the counter while the main code reads it. Expensive reads of
+    // ARM_DWT_CYCCNT make the ISR hit between LDREX and STREX, which must then retry
+    sim::setReadCost(2000);
+    IntervalTimer timer;
+    timer.begin(isr, 5);
+    uint32_t failures = sim::strexFailures();
+    uint64_t last     = 0;
+    unsigned errors   = 0;
+    for (int i = 0; i < 200'000; i++)
+    {
+        uint64_t now = cycles64::get();
+        if (now < last) errors++;
+        last = now;
+    }
+    timer.end();
+    CHECK_EQ(errors, 0u);
+    CHECK_EQ(isrErrors, 0u);
+    CHECK(sim::strexFailures() > failures);
+    CHECK(tracks());
+    CHECK(sim::cycles() > 4 * (1ull << 32)); // several overflows covered
+
+    return simTest::result();
+}
@@ -0,0 +1,110 @@
+// attachDeferredInterruptEx: drain order and completeness from yield(), partial drains,
+// queue overflow (drop counter, oldest events kept) and the high water mark
+
+#include "Arduino.h"
+#include "attachInterruptEx.h"
+#include "attachYieldFunc.h"
+#include "cycles64.h"
+#include "simTest.h"
+#include <vector>
+
+namespace
+{
+    std::vector<PinEvent> received;
+    bool draining = false;
+
+    uint8_t level2, level3; // pin levels before the last edges() call
+
+    void onEdge(const PinEvent& ev) { received.push_back(ev); }
+
+    // toggles pin 2 and 3 alternately, n edges, 100 cycles apart
+    void edges(unsigned n)
+    {
+        level2 = sim::getPin(2);
+        level3 = sim::getPin(3);
+        for (unsigned i = 0; i < n; i++)
+        {
+            uint8_t pin = (i & 1) ? 3 : 2;
+            sim::setPin(pin, !sim::getPin(pin));
+            sim::advance(100);
+        }
+    }
+
+    // events are in the order of the edges, with alternating pins, increasing timestamps and the new level
+    bool ordered(unsigned first, unsigned n)
+    {
+        uint64_t last = 0;
+        for (unsigned i = first; i < first + n; i++)
+        {
+            const PinEvent& ev = received[i];
+            uint8_t expected   = ((i - first) & 1) ? 3 : 2;
+            uint8_t& level     = expected == 2 ? level2 : level3;
+            level              = !level;
+            if (ev.pin != expected || ev.level != level || ev.timestamp <= last) return false;
+            last = ev.timestamp;
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    cycles64::begin();
+    pinMode(2, INPUT);
+    pinMode(3, INPUT);
+    attachDeferredInterruptEx(2, onEdge, CHANGE);
+    attachDeferredInterruptEx(3, onEdge, CHANGE);
+    attachYieldFunc([] {
+        if (draining) processDeferredInterrupts();
+    });
+
+    // nothing is called from the interrupt, all events are delivered in order from yield()
+    edges(40);
+    CHECK(received.empty());
+    DeferredStats stats = getDeferredStats();
+    CHECK_EQ(stats.highWaterMark, 40u);
+    CHECK_EQ(stats.overflows, 0u);
+    CHECK_EQ(stats.capacity, (uint32_t)DEFERRED_QUEUE_SIZE);
+
+    draining = true;
+    yield();
+    draining = false;
+    CHECK_EQ(received.size(), 40u);
+    CHECK(ordered(0, 40));
+
+    // partial drain, the rest stays queued in order
+    received.clear();
+    edges(10);
+    CHECK_EQ(processDeferredInterrupts(4), 4u);
+    CHECK_EQ(processDeferredInterrupts(), 6u);
+    CHECK_EQ(processDeferredInterrupts(), 0u);
+    CHECK(ordered(0, 10));
+
+    // overflow: the newest events are dropped and counted, the queued ones are complete
+    resetDeferredStats();
+    received.clear();
+    edges(DEFERRED_QUEUE_SIZE + 10);
+    stats = getDeferredStats();
+    CHECK_EQ(stats.overflows, 10u);
+    CHECK_EQ(stats.highWaterMark, (uint32_t)DEFERRED_QUEUE_SIZE);
+
+    draining = true;
+    yield();
+    CHECK_EQ(received.size(), (size_t)DEFERRED_QUEUE_SIZE);
+    CHECK(ordered(0, DEFERRED_QUEUE_SIZE));
+
+    // queue is usable again after the overflow, the high water mark is kept until reset
+    received.clear();
+    edges(2);
+    yield();
+    CHECK_EQ(received.size(), 2u);
+    stats = getDeferredStats();
+    CHECK_EQ(stats.overflows, 10u);
+    CHECK_EQ(stats.highWaterMark, (uint32_t)DEFERRED_QUEUE_SIZE);
+    resetDeferredStats();
+    stats = getDeferredStats();
+    CHECK_EQ(stats.overflows, 0u);
+    CHECK_EQ(stats.highWaterMark, 0u);
+
+    return simTest::result();
+}
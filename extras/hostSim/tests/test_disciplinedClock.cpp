@@ -0,0 +1,61 @@
+// teensy_disciplined_clock: locks to the RTC with an injected crystal error, follows a
+// change of the error without jumps and steps if the RTC is set
+
+#include "Arduino.h"
+#include "simTest.h"
+#include "teensy_disciplined_clock.h"
+
+using clk = teensy_disciplined_clock;
+
+namespace
+{
+    constexpr int32_t oneMicro = F_CPU / 1'000'000;
+
+    // runs for the given seconds in 10ms steps, returns false if the clock went backwards or jumped by more than 1ms
+    bool runSmooth(unsigned seconds)
+    {
+        auto last = clk::now();
+        for (unsigned i = 0; i < seconds * 100; i++)
+        {
+            sim::advance(F_CPU / 100);
+            auto now = clk::now();
+            auto dt  = (now - last).count();
+            if (dt < 0 || dt > F_CPU / 100 + F_CPU / 1000) return false;
+            last = now;
+        }
+        return true;
+    }
+
+    bool near(int64_t a, int64_t b, int64_t tolerance) { return a - b <= tolerance && b - a <= tolerance; }
+}
+
+int main()
+{
+    sim::reset();
+    sim::setCrystalError(+50);
+    sim::setRtc(1'000'000);
+    clk::begin();
+    sim::advance(3 * F_CPU); // the first edge sets the clock to the RTC (step)
+
+    CHECK(runSmooth(60));
+    CHECK(clk::isLocked());
+    CHECK(near(clk::frequencyError(), 50'000, 500)); // ppb
+    CHECK(near(clk::phaseError(), 0, oneMicro));
+    CHECK_EQ(clk::to_time_t(clk::now()), (std::time_t)rtc_get());
+
+    // crystal drifts (e.g. temperature), the clock slews without jumps
+    sim::setCrystalError(-120);
+    CHECK(runSmooth(60));
+    CHECK(clk::isLocked());
+    CHECK(near(clk::frequencyError(), -120'000, 500));
+    CHECK(near(clk::phaseError(), 0, oneMicro));
+
+    // RTC set by the user -> the clock steps
+    rtc_set(rtc_get() + 3600);
+    sim::advance(2 * F_CPU);
+    CHECK_EQ(clk::to_time_t(clk::now()), (std::time_t)rtc_get());
+    CHECK(runSmooth(30));
+    CHECK(clk::isLocked());
+
+    return simTest::result();
+}
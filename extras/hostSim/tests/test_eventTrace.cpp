@@ -0,0 +1,169 @@
+// EventTrace: record framing (type, length, payload), encoded size of typical events,
+// dropped events and the lost record, begin() refused while a previous recording fills the buffer
+
+#include "Arduino.h"
+#include "eventTrace.h"
+#include "hostSim.h"
+#include "simTest.h"
+#include <vector>
+
+namespace
+{
+    struct MemoryStream : Stream // accepts up to 'space' bytes per availableForWrite() call
+    {
+        std::vector<uint8_t> data;
+        int space = 4096;
+
+        size_t write(uint8_t b) override { return write(&b, 1); }
+        size_t write(const uint8_t* buf, size_t n) override
+        {
+            data.insert(data.end(), buf, buf + n);
+            return n;
+        }
+        int availableForWrite() override { return space; }
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+    };
+
+    struct Record
+    {
+        uint8_t header;
+        std::vector<uint64_t> fields; // decoded varints of the payload
+        size_t length;
+    };
+
+    // walks the stream by the length bytes, checks that each payload consists of complete varints
+    std::vector<Record> parse(const std::vector<uint8_t>& data)
+    {
+        std::vector<Record> records;
+        size_t pos = 0;
+        while (pos + 2 <= data.size())
+        {
+            Record r{data[pos], {}, data[pos + 1]};
+            size_t end = pos + 2 + r.length;
+            CHECK(end <= data.size());
+            if (end > data.size()) break;
+
+            size_t p = pos + 2;
+            if ((r.header & 0x7F) == (uint8_t)EventTrace::Type::start) p += 4; // magic
+            if ((r.header & 0x7F) == (uint8_t)EventTrace::Type::name) end = p + 2; // id, length (short names only)
+            uint64_t v = 0;
+            unsigned shift = 0;
+            for (; p < end; p++)
+            {
+                v |= (uint64_t)(data[p] & 0x7F) << shift;
+                shift += 7;
+                if (!(data[p] & 0x80))
+                {
+                    r.fields.push_back(v);
+                    v = shift = 0;
+                }
+            }
+            CHECK_EQ(shift, 0u); // no varint crosses the end of the record
+            records.push_back(r);
+            pos += 2 + r.length;
+        }
+        CHECK_EQ(pos, data.size());
+        return records;
+    }
+
+    void testFraming()
+    {
+        MemoryStream s;
+        CHECK(EventTrace::begin(s, false));
+        EventTrace::setName(0x45, "E");
+
+        uint32_t events = EventTrace::getStats().events;
+        for (uint32_t i = 0; i < 200; i++)
+        {
+            sim::advance(100 + i);
+            TRACE_BEGIN(0x45 + (i & 3));        // ids and deltas containing 0x45 ('E')
+            sim::advance(0x45);
+            TRACE_END(0x45 + (i & 3));
+        }
+        EventTrace::drain();
+        EventTrace::end();
+
+        std::vector<Record> records = parse(s.data);
+        CHECK(records.size() == 2 + 400);
+        CHECK_EQ(records[0].header, (uint8_t)EventTrace::Type::start);
+        CHECK(s.data[2] == 'E' && s.data[3] == 'T' && s.data[4] == 'R' && s.data[5] == '2');
+        CHECK_EQ(records[0].fields[0], (uint64_t)F_CPU);
+        CHECK_EQ(records[1].header, (uint8_t)EventTrace::Type::name);
+        CHECK_EQ(records[1].fields[0], 0x45u);
+        CHECK_EQ(EventTrace::getStats().events - events, 400u);
+
+        size_t eventBytes = 0;
+        for (size_t i = 2; i < records.size(); i++)
+        {
+            CHECK_EQ(records[i].header, (uint8_t)(i & 1 ? EventTrace::Type::end : EventTrace::Type::begin));
+            CHECK_EQ(records[i].fields.size(), 2u);
+            eventBytes += 2 + records[i].length;
+        }
+        double bytesPerEvent = (double)eventBytes / 400;
+        printf("%.2f bytes per event\n", bytesPerEvent);
+        CHECK(bytesPerEvent <= 6);
+    }
+
+    void testDropped()
+    {
+        MemoryStream s;
+        CHECK(EventTrace::begin(s, false));
+        s.space = 0; // stream stalled, the buffer fills up
+
+        uint32_t dropped = EventTrace::getStats().dropped;
+        for (int i = 0; i < TRACE_BUFFER_SIZE; i++) TRACE_INSTANT(1);
+        uint32_t n = EventTrace::getStats().dropped - dropped;
+        CHECK(n > 0);
+
+        s.space = 4096;
+        EventTrace::drain();
+        TRACE_INSTANT(2); // reports the dropped events first
+        EventTrace::drain();
+        EventTrace::end();
+
+        std::vector<Record> records = parse(s.data);
+        CHECK(records.size() >= 3);
+        const Record& lost = records[records.size() - 2];
+        CHECK_EQ(lost.header, (uint8_t)EventTrace::Type::lost);
+        CHECK_EQ(lost.fields[0], (uint64_t)n);
+        CHECK_EQ(records.back().header, (uint8_t)EventTrace::Type::instant);
+        CHECK(EventTrace::getStats().highWaterMark <= TRACE_BUFFER_SIZE);
+    }
+
+    void testRestartFull()
+    {
+        MemoryStream s;
+        s.space = 0;
+        CHECK(EventTrace::begin(s, false));
+        for (int i = 0; i < TRACE_BUFFER_SIZE; i++) TRACE_INSTANT(1); // fills the buffer
+        EventTrace::end();
+
+        CHECK(!EventTrace::begin(s, false)); // no room for the stream header
+        uint32_t events = EventTrace::getStats().events;
+        TRACE_INSTANT(2);
+        CHECK_EQ(EventTrace::getStats().events, events); // not recording
+
+        s.space = 4096;
+        EventTrace::drain();
+        s.data.clear();
+        CHECK(EventTrace::begin(s, false));
+        TRACE_INSTANT(3);
+        EventTrace::drain();
+        EventTrace::end();
+
+        std::vector<Record> records = parse(s.data);
+        CHECK_EQ(records.size(), 2u);
+        CHECK_EQ(records[0].header, (uint8_t)EventTrace::Type::start);
+        CHECK_EQ(records[1].header, (uint8_t)EventTrace::Type::instant);
+    }
+}
+
+int main()
+{
+    testFraming();
+    testDropped();
+    testRestartFull();
+    return simTest::result();
+}
@@ -0,0 +1,115 @@
+// fast_duration_cast: compares the reciprocal division with the exact 128 bit result
+//  - all 2^32 cycle counts for the conversions to µs, ms and s (via the step boundaries)
+//    and the first 2^26 cycle counts for ns
+//  - all divisors 1..2^16 and the F_CPU ratios, each with the inputs around every
+//    multiple boundary, near 2^64 and a pseudo random sample
+//  - the public casts for all teensy_clock target units
+
+#include "Arduino.h"
+#include "fast_duration_cast.h"
+#include "simTest.h"
+#include "teensy_clock.h"
+
+using namespace fast_chrono::detail;
+using u128 = unsigned __int128;
+
+namespace
+{
+    uint64_t rnd() // xorshift64*
+    {
+        static uint64_t x = 0x9E37'79B9'7F4A'7C15;
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        return x * 0x2545'F491'4F6C'DD1D;
+    }
+
+    // returns the number of wrong results for divisor d
+    unsigned checkDivisor(uint64_t d, unsigned randomInputs)
+    {
+        const Divider D = makeDivider(d);
+        unsigned wrong  = 0;
+        auto check      = [&](uint64_t n) { wrong += divide(n, D) != n / d; };
+
+        for (uint64_t n = 0; n < 1024; n++) check(n);
+        for (uint64_t k = 1; k < 1024; k++) // around multiples of d
+        {
+            u128 m = (u128)k * d;
+            if (m > UINT64_MAX) break;
+            check((uint64_t)m - 1);
+            check((uint64_t)m);
+            if ((uint64_t)m != UINT64_MAX) check((uint64_t)m + 1);
+        }
+        uint64_t lastMultiple = UINT64_MAX / d * d; // around the top of the range
+        check(lastMultiple);
+        check(lastMultiple - 1);
+        for (uint64_t i = 0; i < 64; i++) check(UINT64_MAX - i);
+        for (uint64_t b = 0; b < 64; b++) check(1ull << b), check((1ull << b) - 1);
+        for (unsigned i = 0; i < randomInputs; i++) check(rnd() >> (rnd() & 63));
+        return wrong;
+    }
+
+    template <class To>
+    unsigned checkCast(uint64_t cycles)
+    {
+        teensy_clock::duration d(cycles);
+        using cf       = std::ratio_divide<teensy_clock::period, typename To::period>;
+        u128 reference = (u128)cycles * cf::num / cf::den;
+        if (reference > UINT64_MAX) return 0; // not representable in To
+        return (u128)fast_duration_cast<To>(d).count() != reference;
+    }
+
+    template <class To>
+    unsigned checkSteps(uint64_t d) // cycles per unit of To
+    {
+        unsigned wrong = 0;
+        for (uint64_t k = 1; k * d <= (1ull << 32); k++) wrong += checkCast<To>(k * d - 1) + checkCast<To>(k * d);
+        return wrong;
+    }
+
+    template <class To>
+    unsigned checkCastRange(unsigned randomInputs)
+    {
+        unsigned wrong = 0;
+        for (unsigned i = 0; i < randomInputs; i++) wrong += checkCast<To>(rnd() >> (rnd() & 63));
+        for (uint64_t i = 0; i < 4096; i++) wrong += checkCast<To>(i) + checkCast<To>(UINT64_MAX - i);
+        return wrong;
+    }
+}
+
+int main()
+{
+    // all 2^32 cycle counts for µs, ms and s: floor(n / d) is a step function and the
+    // reciprocal division is monotonic in n, so both agree for all n if they agree at
+    // both sides of each step, i.e. at k*d - 1 and k*d
+    using ms = std::chrono::duration<uint64_t, std::milli>;
+    using us = std::chrono::duration<uint64_t, std::micro>;
+    using s  = std::chrono::duration<uint64_t>;
+    CHECK_EQ(checkSteps<us>(F_CPU / 1'000'000), 0u);
+    CHECK_EQ(checkSteps<ms>(F_CPU / 1000), 0u);
+    CHECK_EQ(checkSteps<s>(F_CPU), 0u);
+
+    // ns = n * 5 / 3 (at 600MHz) is not a plain division, check the first 2^26 cycles one by one
+    using ns       = std::chrono::duration<uint64_t, std::nano>;
+    unsigned wrong = 0;
+    for (uint64_t c = 0; c < (1 << 26); c++) wrong += checkCast<ns>(c);
+    CHECK_EQ(wrong, 0u);
+
+    // divider for all small divisors and the ones used by teensy_clock
+    wrong = 0;
+    for (uint64_t d = 1; d <= 65536; d++) wrong += checkDivisor(d, 16);
+    CHECK_EQ(wrong, 0u);
+
+    wrong = 0;
+    const uint64_t divisors[] = {F_CPU, F_CPU / 1000, F_CPU / 1'000'000, 3, 7, 641, 6'700'417, UINT64_MAX, UINT64_MAX / 3, 1ull << 63, (1ull << 63) + 1};
+    for (uint64_t d : divisors) wrong += checkDivisor(d, 1'000'000);
+    CHECK_EQ(wrong, 0u);
+
+    // public casts, including the ones where count * num overflows 64 bit
+    CHECK_EQ(checkCastRange<ns>(1'000'000), 0u);
+    CHECK_EQ(checkCastRange<us>(1'000'000), 0u);
+    CHECK_EQ(checkCastRange<ms>(1'000'000), 0u);
+    CHECK_EQ(checkCastRange<s>(1'000'000), 0u);
+
+    return simTest::result();
+}
@@ -0,0 +1,115 @@
+// Smoke test of the simulated core: timers, pin interrupts, masking, yield, TimerWheel and BUS
+
+#include "Arduino.h"
+#include "IntervalTimerEx.h"
+#include "TimerWheel.h"
+#include "attachInterruptEx.h"
+#include "attachYieldFunc.h"
+#include "simTest.h"
+#include "teensy_clock.h"
+
+#if defined(ARDUINO_TEENSY_MICROMOD)
+    #include "MicroModT4.h"
+#endif
+
+int main()
+{
+    sim::reset();
+    cycles64::begin();
+
+    int ticks = 0;
+    IntervalTimerEx timer;
+    timer.begin([&] { ticks++; }, 1000);
+    sim::advance(F_CPU / 10); // 100ms
+    CHECK_EQ(ticks, 100);
+    timer.end();
+
+    int edges = 0;
+    pinMode(5, INPUT);
+    attachInterruptEx(5, [&] { edges++; }, RISING);
+    for (int i = 0; i < 10; i++)
+    {
+        sim::setPin(5, 1);
+        sim::setPin(5, 0);
+    }
+    CHECK_EQ(edges, 10);
+
+    noInterrupts();
+    sim::setPin(5, 1);
+    CHECK_EQ(edges, 10); // deferred while masked
+    interrupts();
+    CHECK_EQ(edges, 11);
+    attachInterruptEx(5, nullptr, RISING); // empty callback detaches
+    sim::setPin(5, 0);
+    sim::setPin(5, 1);
+    CHECK_EQ(edges, 11);
+    detachInterrupt(5);
+
+    attachInterruptEx(CORE_NUM_DIGITAL, [&] { edges++; }, RISING); // out of range pins are ignored
+    attachDeferredInterruptEx(200, [](const PinEvent&) {}, RISING);
+
+    sim::advance(10ull * F_CPU); // cycles64 must survive several CYCCNT wraps
+    uint64_t c64 = cycles64::get();
+    CHECK(c64 >= 10ull * F_CPU);
+    CHECK(sim::cycles() - c64 < 100);
+
+    static int yieldCalls;
+    attachYieldFunc([] { yieldCalls++; });
+    for (int i = 0; i < 10; i++) yield();
+    CHECK(yieldCalls >= 10);
+
+    TimerWheel wheel;
+    wheel.begin(std::chrono::milliseconds(1));
+    TimerWheel::Timer wt;
+    int fired = 0;
+    wheel.start(wt, [&] { fired++; }, std::chrono::milliseconds(50));
+    sim::advance(F_CPU / 1000 * 49);
+    CHECK_EQ(fired, 0);
+    sim::advance(F_CPU / 1000 * 3);
+    CHECK_EQ(fired, 1);
+
+#if defined(ARDUINO_TEENSY_MICROMOD)
+    auto& bus = MMT::mmBus;
+    bus.pinMode(OUTPUT);
+    bus = 0xA5;
+    CHECK_EQ((uint8_t)bus, 0xA5);
+
+    uint8_t data[4] = {1, 2, 3, 0x5A};
+    bus.write(data, 4);
+    CHECK_EQ((uint8_t)bus, 0x5A);
+
+    uint32_t dmaBuf[4];
+    uint8_t dmaData[4] = {9, 8, 7, 0x3C};
+    bus.writeDMA(dmaData, 4, dmaBuf);
+    while (bus.dmaBusy()) {}
+    CHECK_EQ((uint8_t)bus, 0x3C);
+
+    bus.writeDMA(dmaData, 4, dmaBuf); // writes during a transfer wait for its end instead of getting lost
+    bus = 0x11;
+    CHECK(!bus.dmaBusy());
+    CHECK_EQ((uint8_t)bus, 0x11);
+
+    uint64_t start = sim::cycles(); // paced by the PIT: 2MB/s -> 12 ticks of 24MHz = 300 cycles per byte
+    CHECK(bus.writeDMA(dmaData, 4, dmaBuf, 2'000'000));
+    CHECK(bus.dmaBusy());
+    sim::advance(2 * 300 - 10);
+    CHECK(bus.dmaBusy());
+    CHECK_EQ((GPIO2_DR >> 4) & 0xFF, 9u); // first byte out, second one not yet (pins are on GPIO2 during the transfer)
+    while (bus.dmaBusy()) {}
+    CHECK_EQ(sim::cycles() - start, 4 * 300u);
+    CHECK_EQ((uint8_t)bus, 0x3C);
+    CHECK_EQ(IMXRT_PIT_CHANNELS[0].TCTRL, 0u); // PIT channel released
+
+    IMXRT_PIT_CHANNELS[0].TCTRL = PIT_TCTRL_TEN; // used by someone else -> next free channel
+    CHECK(bus.writeDMA(dmaData, 4, dmaBuf));
+    CHECK_EQ(IMXRT_PIT_CHANNELS[1].TCTRL, PIT_TCTRL_TEN);
+    while (bus.dmaBusy()) {}
+    CHECK_EQ(IMXRT_PIT_CHANNELS[0].TCTRL, PIT_TCTRL_TEN);
+    CHECK_EQ(IMXRT_PIT_CHANNELS[1].TCTRL, 0u);
+
+    CHECK(!bus.writeDMA(dmaData, 4, dmaBuf, 7'000'000)); // too fast
+    CHECK(!bus.writeDMA(dmaData, 4, dmaBuf, 0));
+#endif
+
+    return simTest::result();
+}
@@ -0,0 +1,70 @@
+// InstanceArray: swap remove, hot fields, instances which don't fit into the array
+
+#include "Arduino.h"
+#include "instanceArray.h"
+#include "simTest.h"
+
+namespace
+{
+    struct Motion
+    {
+        int pos, vel;
+    };
+
+    struct Axis : InstanceArray<Axis, 4, Motion>
+    {
+        Axis(int v) { hot().vel = v; } // like the README example, also for unregistered instances
+
+        using InstanceArray::for_each_hot;
+        using InstanceArray::hot;
+        using InstanceArray::instanceList;
+        using InstanceArray::registered;
+        using InstanceArray::size;
+    };
+
+    int sumVel()
+    {
+        int sum = 0;
+        for (Axis& a : Axis::instanceList) sum += a.hot().vel;
+        return sum;
+    }
+}
+
+int main()
+{
+    {
+        Axis a(1), b(2), c(4), d(8);
+        CHECK_EQ(Axis::size(), 4u);
+        CHECK_EQ(sumVel(), 15);
+
+        {
+            Axis overflow(16); // array full: not registered, hot() must not write behind the array
+            CHECK(!overflow.registered());
+            CHECK_EQ(Axis::size(), 4u);
+            CHECK_EQ(sumVel(), 15);
+            CHECK_EQ(d.hot().vel, 8);
+        }
+        CHECK_EQ(Axis::size(), 4u);
+
+        {
+            Axis copy(a); // doesn't fit either
+            CHECK(!copy.registered());
+        }
+
+        b.~Axis(); // swap remove, d moves into b's slot
+        CHECK_EQ(Axis::size(), 3u);
+        CHECK_EQ(sumVel(), 13);
+        CHECK_EQ(d.hot().vel, 8);
+        new (&b) Axis(32);
+        CHECK(b.registered());
+        CHECK_EQ(sumVel(), 45);
+
+        Axis::for_each_hot([](Motion& m) { m.pos += m.vel; });
+        CHECK_EQ(a.hot().pos, 1);
+        CHECK_EQ(d.hot().pos, 8);
+        CHECK_EQ(b.hot().pos, 32);
+    }
+    CHECK_EQ(Axis::size(), 0u);
+
+    return simTest::result();
+}
@@ -0,0 +1,113 @@
+// InstanceList: link integrity under random creation / destruction from the loop and from
+// an interrupt which fires while the loop traverses the list, copies
+
+#include "Arduino.h"
+#include "instanceList.h"
+#include "simTest.h"
+#include <new>
+#include <random>
+
+namespace
+{
+    constexpr unsigned IRQ_TEST = 100;
+
+    struct Node : InstanceList<Node>
+    {
+        Node(unsigned _slot) : slot(_slot) {}
+        unsigned slot;
+
+        using InstanceList<Node>::instanceList;
+
+        static Node* node(InstanceList<Node>* p) { return static_cast<Node*>(p); }
+
+        static unsigned check() // verifies the links, returns the number of nodes
+        {
+            unsigned n = 0;
+            Node* prev = nullptr;
+            for (Node* p = node(first); p != nullptr; p = node(p->next))
+            {
+                CHECK(p->prev == prev);
+                prev = p;
+                n++;
+            }
+            return n;
+        }
+    };
+
+    constexpr unsigned slots = 64; // 0..31 owned by the loop, 32..63 by the interrupt
+    alignas(Node) uint8_t storage[slots][sizeof(Node)];
+    bool alive[slots];
+    unsigned nrAlive;
+
+    std::mt19937 rng(1234);
+    Node* current = nullptr; // node the loop is working on, the interrupt must not destroy it
+
+    Node* at(unsigned slot) { return (Node*)storage[slot]; }
+
+    void toggleSlot(unsigned slot)
+    {
+        if (alive[slot])
+        {
+            if (at(slot) == current) return;
+            at(slot)->~Node();
+            alive[slot] = false;
+            nrAlive--;
+        }
+        else
+        {
+            new (storage[slot]) Node(slot);
+            alive[slot] = true;
+            nrAlive++;
+        }
+    }
+
+    void isr()
+    {
+        for (int i = 0; i < 3; i++) toggleSlot(slots / 2 + rng() % (slots / 2));
+    }
+}
+
+int main()
+{
+    attachInterruptVector((IRQ_NUMBER_t)IRQ_TEST, isr);
+    NVIC_ENABLE_IRQ(IRQ_TEST);
+
+    for (unsigned round = 0; round < 20'000; round++)
+    {
+        toggleSlot(rng() % (slots / 2));
+
+        unsigned visited = 0;
+        for (Node& n : Node::instanceList)
+        {
+            current = &n;
+            CHECK(alive[n.slot]);
+            if (rng() % 8 == 0) NVIC_TRIGGER_IRQ(IRQ_TEST);
+            visited++;
+        }
+        current = nullptr;
+        CHECK(visited <= slots);
+        CHECK_EQ(Node::check(), nrAlive);
+    }
+
+    for (unsigned slot = 0; slot < slots; slot++)
+    {
+        if (alive[slot]) toggleSlot(slot);
+    }
+    CHECK_EQ(Node::check(), 0u);
+
+    // copies are new instances, assignment keeps the links
+    {
+        Node a(1);
+        Node b(a);
+        CHECK_EQ(Node::check(), 2u);
+        {
+            Node c(3);
+            c = a;
+            CHECK_EQ(Node::check(), 3u);
+        }
+        CHECK_EQ(Node::check(), 2u);
+    }
+    CHECK_EQ(Node::check(), 0u);
+
+    return simTest::result();
+}
@@ -0,0 +1,83 @@
+// MemoryTool memory map: region lookup and the DMA buffer checks (constant addresses,
+// the linker symbol split of classify() needs the real board). Largest free block and
+// fragmentation on a heap with holes, laid out like the newlib malloc free lists
+
+#include "Arduino.h"
+#include "memoryTool.h"
+#include "simTest.h"
+#include <cstring>
+
+using namespace MemoryTool;
+
+static_assert(isDmaSafeRx(0x2020'0000, 64), "usable in constant expressions");
+
+namespace
+{
+    MallocChunk* av[2 * mallocBins + 2]; // same layout as newlib's __malloc_av_
+    alignas(8) uint8_t heap[1024];
+
+    MallocChunk* bin(unsigned i) { return (MallocChunk*)((uint8_t*)&av[2 * i + 2] - offsetof(MallocChunk, fd)); }
+
+    void clearBins()
+    {
+        for (unsigned i = 0; i < mallocBins; i++) bin(i)->fd = bin(i)->bk = bin(i);
+    }
+
+    void freeChunk(unsigned offset, size_t size, unsigned binNr) // links a free chunk at heap + offset into a bin
+    {
+        MallocChunk* c = (MallocChunk*)(heap + offset);
+        MallocChunk* b = bin(binNr);
+        c->size        = size | 1; // previous chunk in use
+        c->fd          = b->fd;
+        c->bk          = b;
+        b->fd->bk      = c;
+        b->fd          = c;
+    }
+
+    void testFreeLists()
+    {
+        clearBins();
+        CHECK_EQ(largestFreeChunk(av), 0u);
+
+        // used, free 48, used, free 200, used, free 64, used ... (holes between allocated blocks)
+        freeChunk(64, 48, 6);
+        freeChunk(160, 200, 25);
+        freeChunk(512, 64, 8);
+        freeChunk(700, 56, 6); // second chunk in the same bin
+        bin(0)->fd = (MallocChunk*)(heap + 900); // top chunk, not walked
+        CHECK_EQ(largestFreeChunk(av), 200u - sizeof(size_t));
+
+        uint32_t free    = 48 + 200 + 64 + 56;
+        uint32_t largest = 200;
+        CHECK_EQ(fragmentation(largest, free), 46u); // 100 * (1 - 200 / 368)
+        CHECK_EQ(fragmentation(free, free), 0u);
+        CHECK_EQ(fragmentation(0, 0), 0u);
+    }
+}
+
+int main()
+{
+    testFreeLists();
+
+    CHECK(strcmp(regionOf(0x2000'1000).name, "DTCM") == 0);
+    CHECK(regionOf(0x2020'1000).region == Region::dmamem);
+    CHECK(regionOf(0x4000'0000).region == Region::unknown);
+    CHECK(strcmp(regionName(Region::heap), "HEAP (on RAM-2)") == 0);
+
+    // DTCM: not cached, any alignment
+    CHECK(isDmaSafeTx(0x2000'0003, 5));
+    CHECK(isDmaSafeRx(0x2000'0003, 5));
+
+    // OCRAM: transmit at any alignment, receive only whole cache lines
+    CHECK(isDmaSafeTx(0x2020'0004, 10));
+    CHECK(!isDmaSafeRx(0x2020'0004, 10));
+    CHECK(!isDmaSafeRx(0x2020'0000, 40));
+    CHECK(isDmaSafeRx(0x2020'0020, 64));
+
+    // not reachable or crossing the end of the region
+    CHECK(!isDmaSafeTx(0x0000'1000, 16)); // ITCM
+    CHECK(!isDmaSafeTx(0x6000'1000, 16)); // FLASH
+    CHECK(!isDmaSafeTx(0x2027'FFF0, 32));
+    CHECK(!isDmaSafeTx(0x2020'0000, 0));
+    return simTest::result();
+}
@@ -0,0 +1,131 @@
+// Allocation tracker (global new/delete replaced, malloc & co wrapped by the linker): live and
+// peak bytes across new/delete/malloc/calloc/realloc, per site figures, forbidden allocations
+// in nested NoAllocScopes and in interrupt handlers
+
+#include "Arduino.h"
+#include "memoryTool.h"
+#include "simTest.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace MemoryTool;
+
+namespace
+{
+    void* volatile keep; // stores the results, the compiler must not elide the allocations
+    void* volatile keep2;
+
+    constexpr unsigned IRQ_TEST = 100;
+    void allocatingIsr()
+    {
+        keep2 = malloc(16);
+    }
+
+    uint32_t siteLiveBytes()
+    {
+        static AllocationSite table[ALLOCATION_SITES];
+        unsigned n   = getAllocationSites(table, ALLOCATION_SITES);
+        uint32_t sum = 0;
+        for (unsigned i = 0; i < n; i++) sum += table[i].liveBytes;
+        return sum;
+    }
+}
+
+int main()
+{
+    resetAllocationStats();
+    const AllocationStats base = getAllocationStats(); // the runtime might hold some blocks already
+
+    // new / delete
+    int* a = new int[10];
+    keep   = a;
+    AllocationStats s = getAllocationStats();
+    CHECK_EQ(s.allocs, 1u);
+    CHECK_EQ(s.liveBytes - base.liveBytes, 40u);
+
+    // malloc and realloc growing / shrinking, realloc doesn't count as new allocation
+    char* m = (char*)malloc(100);
+    keep    = m;
+    std::memset(m, 0x5A, 100);
+    m    = (char*)realloc(m, 300);
+    keep = m;
+    s    = getAllocationStats();
+    CHECK_EQ(s.allocs, 2u);
+    CHECK_EQ(s.liveBytes - base.liveBytes, 340u);
+    CHECK_EQ(s.peakBytes - base.liveBytes, 340u);
+    CHECK(m[0] == 0x5A && m[99] == 0x5A); // content moved along
+
+    m    = (char*)realloc(m, 50);
+    keep = m;
+    s    = getAllocationStats();
+    CHECK_EQ(s.liveBytes - base.liveBytes, 90u);
+    CHECK_EQ(s.peakBytes - base.liveBytes, 340u);
+
+    delete[] a;
+    free(m);
+    s = getAllocationStats();
+    CHECK_EQ(s.frees, 2u);
+    CHECK_EQ(s.liveBytes, base.liveBytes);
+    CHECK_EQ(s.peakBytes - base.liveBytes, 340u);
+
+    // calloc, realloc(nullptr) allocates, realloc(p, 0) frees
+    unsigned char* c = (unsigned char*)calloc(4, 25);
+    keep             = c;
+    CHECK(c[0] == 0 && c[99] == 0);
+    void* r = realloc(nullptr, 10);
+    keep    = r;
+    s       = getAllocationStats();
+    CHECK_EQ(s.allocs, 4u);
+    CHECK_EQ(s.liveBytes - base.liveBytes, 110u);
+    keep = realloc(r, 0);
+    free(c);
+    s = getAllocationStats();
+    CHECK_EQ(s.frees, 4u);
+    CHECK_EQ(s.liveBytes, base.liveBytes);
+
+    // the site table adds up to the totals, reset keeps the live bytes and restarts the peak
+    int* kept = new int[25];
+    keep      = kept;
+    s         = getAllocationStats();
+    CHECK(s.sites > 0);
+    if (s.untracked == 0) CHECK_EQ(siteLiveBytes(), s.liveBytes);
+    resetAllocationStats();
+    s = getAllocationStats();
+    CHECK_EQ(s.allocs, 0u);
+    CHECK_EQ(s.liveBytes - base.liveBytes, 100u);
+    CHECK_EQ(s.peakBytes, s.liveBytes);
+    delete[] kept;
+
+    // forbidden allocations: nested scopes, realloc counts, free doesn't
+    CHECK_EQ(getAllocationStats().forbidden, 0u);
+    void* outside = malloc(8);
+    {
+        NoAllocScope outer;
+        keep = new int;
+        CHECK_EQ(getAllocationStats().forbidden, 1u);
+        {
+            NoAllocScope inner;
+            keep = malloc(8);
+            free(keep);
+            CHECK_EQ(getAllocationStats().forbidden, 2u);
+        }
+        delete (int*)keep2; // nullptr, no allocation
+        keep = realloc(outside, 64);
+        CHECK_EQ(getAllocationStats().forbidden, 3u); // still inside the outer scope
+        CHECK(getAllocationStats().lastForbidden != 0);
+        outside = keep;
+    }
+    keep = malloc(8);
+    CHECK_EQ(getAllocationStats().forbidden, 3u);
+    free(keep);
+    free(outside);
+
+    // allocations from an interrupt handler are forbidden without a scope
+    attachInterruptVector((IRQ_NUMBER_t)IRQ_TEST, allocatingIsr);
+    NVIC_ENABLE_IRQ(IRQ_TEST);
+    NVIC_TRIGGER_IRQ(IRQ_TEST);
+    CHECK_EQ(getAllocationStats().forbidden, 4u);
+    free(keep2);
+
+    return simTest::result();
+}
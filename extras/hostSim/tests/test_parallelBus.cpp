@@ -0,0 +1,84 @@
+// ParallelBus: pin table vs. the core, all values across non-contiguous and contiguous pins,
+// other pins of the port keep their level, DR_SET/DR_CLEAR, fast GPIO routing
+
+#include "Arduino.h"
+#include "ParallelBus.h"
+#include "simTest.h"
+
+namespace
+{
+    ParallelBus<2, 3, 4, 5> scattered;   // GPIO9 bits 4, 5, 6, 8 (bit 7 is pin 33)
+    ParallelBus<5, 2, 4, 3> reordered;   // same pins, other bit order
+    ParallelBus<19, 18, 14, 15> nibble;  // GPIO6 bits 16..19, contiguous
+    ParallelBus<10, 12, 11, 13, 6, 9, 8, 7> byteBus; // GPIO7 bits 0, 1, 2, 3, 10, 11, 16, 17
+
+    template <class Bus>
+    uint32_t pinsToValue(std::initializer_list<uint8_t> pins)
+    {
+        uint32_t v = 0;
+        unsigned i = 0;
+        for (uint8_t p : pins) v |= (uint32_t)sim::getPin(p) << i++;
+        return v;
+    }
+}
+
+int main()
+{
+    static_assert(!decltype(scattered)::contiguous && decltype(nibble)::contiguous);
+    static_assert(decltype(scattered)::mask == 0b1'0111'0000 && decltype(scattered)::port == 9);
+    CHECK(scattered.check() && reordered.check() && nibble.check() && byteBus.check());
+
+    pinMode(33, OUTPUT); // between the scattered bus pins
+    digitalWriteFast(33, HIGH);
+    scattered.pinMode(OUTPUT);
+
+    for (unsigned v = 0; v < 16; v++)
+    {
+        scattered = v;
+        CHECK_EQ((unsigned)scattered, v);
+        CHECK_EQ(pinsToValue<decltype(scattered)>({2, 3, 4, 5}), v);
+        CHECK_EQ((unsigned)reordered, ((v >> 3) & 1) | ((v << 1) & 0b0010) | (v & 0b0100) | ((v << 2) & 0b1000));
+        CHECK(sim::getPin(33));
+    }
+
+    digitalWriteFast(33, LOW);
+    reordered = 0b0001; // pin 5
+    CHECK_EQ((unsigned)scattered, 0b1000u);
+    CHECK(!sim::getPin(33));
+
+    scattered.set();
+    CHECK_EQ((unsigned)scattered, 0xFu);
+    scattered.clear();
+    CHECK_EQ((unsigned)scattered, 0u);
+    CHECK(!sim::getPin(33));
+
+    nibble.pinMode(OUTPUT);
+    for (unsigned v = 0; v < 16; v++)
+    {
+        nibble = v;
+        CHECK_EQ((unsigned)nibble, v);
+        CHECK_EQ(pinsToValue<decltype(nibble)>({19, 18, 14, 15}), v);
+    }
+
+    byteBus.pinMode(OUTPUT);
+    for (unsigned v = 0; v < 256; v++)
+    {
+        byteBus = v;
+        CHECK_EQ((unsigned)byteBus, v);
+        CHECK_EQ(pinsToValue<decltype(byteBus)>({10, 12, 11, 13, 6, 9, 8, 7}), v);
+    }
+
+    // pins routed to the slow GPIO2 don't follow the fast GPIO7 until pinMode / useFastGPIO
+    IOMUXC_GPR_GPR27 &= ~decltype(byteBus)::mask;
+    byteBus.useFastGPIO();
+    CHECK_EQ(IOMUXC_GPR_GPR27 & decltype(byteBus)::mask, decltype(byteBus)::mask);
+
+    // writes from a critical section of the caller keep interrupts disabled
+    noInterrupts();
+    byteBus = 0x5A;
+    CHECK(!sim::irqEnabled());
+    interrupts();
+    CHECK_EQ((unsigned)byteBus, 0x5Au);
+
+    return simTest::result();
+}
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""
+pcSymbols.py: mapping of the dump lines to functions and the totals per code region,
+old dumps without a region column still work.
+
+usage: test_pcSymbols.py path/to/pcSymbols.py
+"""
+import importlib.util
+import io
+import sys
+from contextlib import redirect_stdout
+
+spec = importlib.util.spec_from_file_location("pcSymbols", sys.argv[1])
+pcs = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(pcs)
+
+failures = 0
+
+
+def check(ok, what):
+    global failures
+    if not ok:
+        print(f"check failed: {what}")
+        failures += 1
+
+
+addrs = [0x0000_0100, 0x0000_0200, 0x6000_1000]
+names = ["filter", "loop", "flashFunc"]
+
+dump = """# samples 100 dropped 0 missed 0 cycles/sample max 200 mean 150
+# region ITCM 0x00000000 0x00008000
+# region FLASH 0x60000000 0x60010000
+0x00000104 50 ITCM
+0x00000108 10 ITCM
+0x00000210 30 ITCM
+0x60001010 9 FLASH
+0x00000010 1 ITCM
+""".splitlines(keepends=True)
+
+with redirect_stdout(io.StringIO()) as out:
+    perSymbol, perRegion = pcs.summarize(dump, addrs, names)
+
+check(perSymbol["filter"] == 60, "two addresses in one function")
+check(perSymbol["loop"] == 30, "loop")
+check(perSymbol["flashFunc"] == 9, "flash function")
+check(perSymbol["???"] == 1, "address below the first symbol")
+check(perRegion == {"ITCM": 91, "FLASH": 9}, f"region totals {dict(perRegion)}")
+check(out.getvalue().count("# region") == 2, "comment lines are passed through")
+
+with redirect_stdout(io.StringIO()):
+    perSymbol, perRegion = pcs.summarize(["0x00000104 5\n"], addrs, names)
+check(perSymbol["filter"] == 5 and perRegion["?"] == 5, "dump without region column")
+
+if failures:
+    print(f"{failures} check(s) failed")
+sys.exit(1 if failures else 0)
@@ -0,0 +1,53 @@
+// PinGroup: bit order across ports, set/clear/toggle, read back
+
+#include "Arduino.h"
+#include "pinModeEx.h"
+#include "simTest.h"
+
+namespace
+{
+    constexpr PinGroup group{2, 14, 3, 10, 4, 5}; // GPIO9, GPIO6, GPIO9, GPIO7, GPIO9, GPIO9
+    constexpr uint8_t pins[] = {2, 14, 3, 10, 4, 5};
+
+    static_assert(group.size() == 6);
+    static_assert(group.portMask(9) == (1u << 4 | 1u << 5 | 1u << 6 | 1u << 8));
+    static_assert(group.portMask(6) == 1u << 18);
+    static_assert(group.portMask(7) == 1u << 0);
+    static_assert(group.portMask(8) == 0);
+
+    uint32_t readPins()
+    {
+        uint32_t v = 0;
+        for (unsigned i = 0; i < 6; i++) v |= (uint32_t)digitalRead(pins[i]) << i;
+        return v;
+    }
+}
+
+int main()
+{
+    sim::reset();
+    group.pinMode(OUTPUT);
+
+    for (uint32_t v : {0b000000u, 0b111111u, 0b101010u, 0b010101u, 0b100001u, 0b011110u})
+    {
+        group.write(v);
+        CHECK_EQ(readPins(), v);
+        CHECK_EQ(group.read(), v);
+    }
+
+    group.clear();
+    CHECK_EQ(readPins(), 0u);
+    group.set();
+    CHECK_EQ(readPins(), 0b111111u);
+    group.write(0b000110);
+    group.toggle();
+    CHECK_EQ(readPins(), 0b111001u);
+
+    pinMode(13, OUTPUT); // other pins of the ports are not touched
+    digitalWrite(13, HIGH);
+    group.write(0);
+    group.set();
+    CHECK_EQ(digitalRead(13), 1);
+
+    return simTest::result();
+}
@@ -0,0 +1,67 @@
+// USE_PORT_DISPATCHER: pins attached with attachInterruptEx and with the core
+// attachInterrupt coexist in any order, empty callbacks detach the pin
+
+#include "Arduino.h"
+#include "attachInterruptEx.h"
+#include "simTest.h"
+
+namespace
+{
+    int coreA, coreB;
+    void onCoreA() { coreA++; }
+    void onCoreB() { coreB++; }
+
+    void pulse(unsigned pin)
+    {
+        sim::setPin(pin, HIGH);
+        sim::setPin(pin, LOW);
+    }
+}
+
+int main()
+{
+    sim::reset();
+    for (unsigned pin : {2, 3, 4, 5, 6}) pinMode(pin, INPUT);
+
+    int ex = 0;
+    attachInterrupt(2, onCoreA, RISING);             // core first...
+    attachInterruptEx(3, [&] { ex++; }, RISING);     // ...then the dispatcher
+    pulse(2);
+    pulse(3);
+    CHECK_EQ(coreA, 1);
+    CHECK_EQ(ex, 1);
+
+    attachInterrupt(4, onCoreB, RISING);             // core reinstalls its handler
+    pulse(2);
+    pulse(3);
+    pulse(4);
+    CHECK_EQ(coreA, 2);
+    CHECK_EQ(ex, 2);
+    CHECK_EQ(coreB, 1);
+
+    int ex2 = 0;
+    attachInterruptEx(5, [&] { ex2++; }, CHANGE);    // dispatcher again
+    pulse(2);
+    pulse(3);
+    pulse(4);
+    pulse(5);
+    CHECK_EQ(coreA, 3);
+    CHECK_EQ(ex, 3);
+    CHECK_EQ(coreB, 2);
+    CHECK_EQ(ex2, 2);
+
+    int ex3 = 0;
+    attachInterruptEx(6, [&] { ex3++; }, RISING);
+    attachInterruptEx(6, nullptr, RISING);           // empty callback detaches the pin, must not throw
+    pulse(6);
+    CHECK_EQ(ex3, 0);
+    CHECK((digital_pin_to_info_PGM[6].reg[5] & digital_pin_to_info_PGM[6].mask) == 0); // IMR bit cleared
+    pulse(3);
+    CHECK_EQ(ex, 4);
+
+    detachInterrupt(3);
+    pulse(3);
+    CHECK_EQ(ex, 4);
+
+    return simTest::result();
+}
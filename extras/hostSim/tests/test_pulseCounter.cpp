@@ -0,0 +1,107 @@
+// Counting mode: edge count, period and frequency; quadrature decoding in both directions,
+// random walks and invalid transitions (missed edges)
+
+#include "Arduino.h"
+#include "attachInterruptEx.h"
+#include "cycles64.h"
+#include "simTest.h"
+#include <random>
+
+namespace
+{
+    constexpr unsigned pinA = 2, pinB = 3, pinC = 4;
+    constexpr uint8_t sequence[4] = {0b00, 0b10, 0b11, 0b01}; // A << 1 | B, A leading B (counts up)
+    unsigned phase = 0;
+
+    void setPhase(unsigned p)
+    {
+        phase = p & 3;
+        sim::setPin(pinA, sequence[phase] & 2);
+        sim::setPin(pinB, sequence[phase] & 1);
+    }
+
+    void step(int dir) { setPhase(phase + dir); } // one edge on one of the pins
+}
+
+int main()
+{
+    sim::reset();
+    cycles64::begin();
+
+    // plain counter --------------------------------------------------------------------
+    pinMode(pinC, INPUT);
+    sim::setPin(pinC, 0);
+    attachCounterInterruptEx(pinC, RISING);
+    for (int i = 0; i < 100; i++)
+    {
+        sim::advance(1000);
+        sim::setPin(pinC, 1);
+        sim::advance(1000);
+        sim::setPin(pinC, 0);
+    }
+    PulseSnapshot s = getPulseSnapshot(pinC);
+    CHECK_EQ(s.count, 100);
+    CHECK(s.period >= 2000 && s.period < 2100); // includes the cycles of the sim calls
+    CHECK(s.frequency > F_CPU / 2100.0f && s.frequency <= F_CPU / 2000.0f);
+    detachInterrupt(pinC);
+    sim::setPin(pinC, 1);
+    CHECK_EQ(getPulseSnapshot(pinC).count, 100);
+
+    // periods of 2^32 cycles and more saturate instead of wrapping around
+    sim::setPin(pinC, 0);
+    attachCounterInterruptEx(pinC, RISING);
+    sim::setPin(pinC, 1);
+    sim::setPin(pinC, 0);
+    sim::advance((1ull << 32) + 1000);
+    sim::setPin(pinC, 1);
+    s = getPulseSnapshot(pinC);
+    CHECK_EQ(s.count, 2);
+    CHECK_EQ(s.period, UINT32_MAX);
+    CHECK(s.frequency > 0.0f && s.frequency <= (float)F_CPU / UINT32_MAX);
+    sim::setPin(pinC, 0);
+    sim::advance(5000);
+    sim::setPin(pinC, 1);
+    s = getPulseSnapshot(pinC);
+    CHECK(s.period >= 5000 && s.period < 5100);
+    detachInterrupt(pinC);
+
+    // quadrature -----------------------------------------------------------------------
+    pinMode(pinA, INPUT);
+    pinMode(pinB, INPUT);
+    setPhase(0);
+    attachQuadratureInterruptEx(pinA, pinB);
+
+    for (int i = 0; i < 400; i++) step(+1);
+    CHECK_EQ(getPulseSnapshot(pinA).count, 400);
+    for (int i = 0; i < 1000; i++) step(-1);
+    CHECK_EQ(getPulseSnapshot(pinA).count, -600);
+
+    std::mt19937 rng(42); // random walk, the decoder has to follow each edge
+    int32_t expected = -600;
+    for (int i = 0; i < 100'000; i++)
+    {
+        int dir = rng() & 1 ? +1 : -1;
+        step(dir);
+        expected += dir;
+    }
+    CHECK_EQ(getPulseSnapshot(pinA).count, expected);
+
+    // both pins change at the same time (missed edge): invalid transition, not counted
+    resetPulseCounter(pinA);
+    noInterrupts();
+    setPhase(phase + 2);
+    interrupts();
+    CHECK_EQ(getPulseSnapshot(pinA).count, 0);
+    step(+1); // the decoder resynchronized to the current state
+    CHECK_EQ(getPulseSnapshot(pinA).count, 1);
+
+    // the counter is stored under pinA only
+    CHECK_EQ(getPulseSnapshot(pinB).count, 0);
+
+    detachInterrupt(pinA);
+    detachInterrupt(pinB);
+    step(+1);
+    CHECK_EQ(getPulseSnapshot(pinA).count, 1);
+
+    return simTest::result();
+}
@@ -0,0 +1,124 @@
+// Arena / Pool: usage bookkeeping, RegionAllocator never handing out nullptr to a
+// container (failure handler, std::bad_alloc if the handler returns) and invalid frees
+
+#include "Arduino.h"
+#include "regionAllocator.h"
+#include "simTest.h"
+#include <list>
+#include <new>
+#include <vector>
+
+using namespace MemoryTool;
+
+namespace
+{
+    alignas(16) uint8_t arenaMem[1024];
+    alignas(16) uint8_t poolMem[64 * 32];
+
+    const RegionResource* failedResource = nullptr;
+    size_t failedBytes                   = 0;
+
+    void recordFailure(const RegionResource& r, size_t bytes)
+    {
+        failedResource = &r;
+        failedBytes    = bytes;
+    }
+
+    unsigned invalidFrees = 0;
+    const void* invalidPtr = nullptr;
+
+    void recordInvalidFree(const RegionResource&, const void* p)
+    {
+        invalidFrees++;
+        invalidPtr = p;
+    }
+
+    void testArena()
+    {
+        Arena arena(arenaMem, "arena");
+        void* a = arena.allocate(100);
+        void* b = arena.allocate(8, 8);
+        CHECK(a == arenaMem);
+        CHECK(arena.owns(b));
+        arena.deallocate(b, 8); // last allocation, released up to its aligned start
+        CHECK_EQ(arena.used(), 104u);
+        CHECK(arena.allocate(2000) == nullptr);
+        CHECK_EQ(arena.failures(), 1u);
+        arena.reset();
+        CHECK_EQ(arena.used(), 0u);
+        CHECK_EQ(arena.peak(), 112u);
+    }
+
+    void testPool()
+    {
+        Pool pool(poolMem, 32, "pool");
+        CHECK_EQ(pool.blocks(), 64u);
+
+        std::vector<void*> blocks;
+        while (void* p = pool.allocate(32)) blocks.push_back(p);
+        CHECK_EQ(blocks.size(), 64u);
+        CHECK_EQ(pool.failures(), 1u);
+        CHECK(pool.allocate(33) == nullptr);
+        for (void* p : blocks) pool.deallocate(p);
+        CHECK_EQ(pool.used(), 0u);
+        CHECK_EQ(pool.peak(), 64u * 32);
+    }
+
+    void testInvalidFree()
+    {
+        Pool pool(poolMem, 32, "pool");
+        void* a = pool.allocate(32);
+        void* b = pool.allocate(32);
+        int onStack;
+
+        setRegionInvalidFreeHandler(recordInvalidFree); // returns, the pointer is ignored
+        pool.deallocate(&onStack);                     // not in the pool
+        pool.deallocate(poolMem + sizeof(poolMem));    // one past the end
+        pool.deallocate((uint8_t*)b + 8);              // inside a block
+        pool.deallocate(nullptr);                      // fine
+        setRegionInvalidFreeHandler(nullptr);
+
+        CHECK_EQ(invalidFrees, 3u);
+        CHECK(invalidPtr == (uint8_t*)b + 8);
+        CHECK_EQ(pool.used(), 2u * 32);
+
+        // the free list is intact: exactly the 62 remaining blocks, all distinct from a and b
+        std::vector<void*> blocks;
+        while (void* p = pool.allocate(32)) blocks.push_back(p);
+        CHECK_EQ(blocks.size(), 62u);
+        for (void* p : blocks) CHECK(p != a && p != b && pool.owns(p));
+    }
+
+    void testContainerFailure()
+    {
+        Pool pool(poolMem, 32, "nodes");
+        std::list<int, RegionAllocator<int, Pool>> list(pool);
+
+        setRegionFailureHandler(recordFailure); // returns, i.e. the allocator throws
+        bool thrown = false;
+        try
+        {
+            for (int i = 0; i < 100; i++) list.push_back(i);
+        }
+        catch (const std::bad_alloc&)
+        {
+            thrown = true;
+        }
+        setRegionFailureHandler(nullptr);
+
+        CHECK(thrown);
+        CHECK_EQ(list.size(), 64u);
+        CHECK(failedResource == &pool);
+        CHECK(failedBytes > 0);
+        CHECK_EQ(list.back(), 63);
+    }
+}
+
+int main()
+{
+    testArena();
+    testPool();
+    testInvalidFree();
+    testContainerFailure();
+    return simTest::result();
+}
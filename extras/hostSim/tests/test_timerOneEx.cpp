@@ -0,0 +1,53 @@
+// TimerOneEx: the binding variants call the right object, attaching with interrupts
+// disabled doesn't enable them
+
+#include "Arduino.h"
+#include "TimerOneEx.h"
+#include "simTest.h"
+
+namespace
+{
+    struct Counter
+    {
+        void tick() { ticks++; }
+        int ticks = 0;
+    };
+
+    Counter a, b;
+}
+
+int main()
+{
+    TimerOneEx<Counter> timer;
+    timer.initialize(1000); // 1ms
+
+    timer.attachInterrupt(&Counter::tick, &a);
+    sim::advance(F_CPU / 1000 * 3 + 10);
+    CHECK_EQ(a.ticks, 3);
+
+    timer.attachInterrupt<&Counter::tick>(&b);
+    sim::advance(F_CPU / 1000 * 2);
+    CHECK_EQ(a.ticks, 3);
+    CHECK_EQ(b.ticks, 2);
+
+    int lambdaTicks = 0;
+    auto lambda     = [&] { lambdaTicks++; };
+    timer.attachInterrupt(lambda);
+    sim::advance(F_CPU / 1000);
+    CHECK_EQ(lambdaTicks, 1);
+    CHECK_EQ(b.ticks, 2);
+
+    // rebinding from a critical section of the caller keeps interrupts disabled
+    noInterrupts();
+    timer.attachInterrupt(&Counter::tick, &a);
+    CHECK(!sim::irqEnabled());
+    sim::advance(F_CPU / 1000 * 2);
+    CHECK_EQ(a.ticks, 3); // postponed
+    interrupts();
+    CHECK(sim::irqEnabled());
+    sim::advance(F_CPU / 1000);
+    CHECK(a.ticks >= 4);
+    CHECK_EQ(lambdaTicks, 1);
+
+    return simTest::result();
+}
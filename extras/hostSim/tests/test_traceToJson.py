@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+traceToJson.py: framing of the records, payload bytes which look like record headers
+('E', type bytes), resynchronization after garbage and a truncated last record.
+
+usage: test_traceToJson.py path/to/traceToJson.py
+"""
+import importlib.util
+import random
+import sys
+
+spec = importlib.util.spec_from_file_location("traceToJson", sys.argv[1])
+t2j = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(t2j)
+
+failures = 0
+
+
+def check(ok, what):
+    global failures
+    if not ok:
+        print(f"check failed: {what}")
+        failures += 1
+
+
+def varint(v):
+    out = bytearray()
+    while v >= 0x80:
+        out.append(v & 0x7F | 0x80)
+        v >>= 7
+    out.append(v)
+    return out
+
+
+def record(header, payload):
+    return bytes([header, len(payload)]) + bytes(payload)
+
+
+def start(fcpu=600_000_000, time=0):
+    return record(t2j.START, b"ETR2" + varint(fcpu) + varint(time))
+
+
+def event(kind, dt, dId, exception=0):
+    payload = (varint(exception) if exception else b"") + varint(dt) + varint((dId << 1) ^ (dId >> 31))
+    return record(kind | (t2j.IN_HANDLER if exception else 0), payload)
+
+
+def events(trace):
+    return [e for e in trace["traceEvents"] if e["ph"] != "M"]
+
+
+# ids and time deltas of 0x45 ('E') put record header look alikes into the payloads
+stream = start() + record(t2j.NAME, varint(0x45) + varint(1) + b"E")
+for i in range(100):
+    stream += event(0, 0x45, 0x45 if i == 0 else 0) + event(1, 0x45 * 128 + 0x45, 0, exception=0x45)
+
+trace, lost, resyncs = t2j.convert(stream)
+check(len(events(trace)) == 200, "all events decoded")
+check(resyncs == 0, "no resync on a clean stream")
+check(all(e["name"] == "E" for e in events(trace)), "names")
+check({e["tid"] for e in events(trace)} == {0, 0x45}, "threads")
+
+# garbage between records and a truncated last record
+rnd = random.Random(1)
+broken = bytearray(stream)
+for pos in sorted(rnd.sample(range(100, len(stream) - 100), 5), reverse=True):
+    broken[pos:pos] = bytes(rnd.randrange(256) for _ in range(rnd.randrange(1, 8)))
+broken += event(0, 1, 1)[:-1]
+
+trace, lost, resyncs = t2j.convert(bytes(broken))
+n = len(events(trace))
+check(190 <= n <= 200, f"events after resync ({n})")
+check(1 <= resyncs <= 5, f"resyncs ({resyncs})")
+times = [e["ts"] for e in events(trace)]
+check(all(a <= b for a, b in zip(times, times[1:])), "timestamps stay ordered")
+
+# lost record
+trace, lost, resyncs = t2j.convert(start() + record(t2j.LOST, varint(17)) + event(2, 10, 1))
+check(lost == 17, "lost events")
+
+if failures:
+    print(f"{failures} check(s) failed")
+sys.exit(1 if failures else 0)
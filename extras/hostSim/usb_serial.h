@@ -0,0 +1,29 @@
+#pragma once
+/************************************************************************************
+ * Serial prints to stdout of the host
+ ************************************************************************************/
+
+#include "Stream.h"
+#include <cstdio>
+
+class usb_serial_class : public Stream
+{
+ public:
+    void begin(long) {}
+    void end() {}
+
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+    using Print::write;
+
+    int availableForWrite() override { return 4096; }
+    void flush() override { fflush(stdout); }
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+    operator bool() { return true; }
+};
+
+extern usb_serial_class Serial;
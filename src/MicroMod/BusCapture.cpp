@@ -0,0 +1,228 @@
+#include "BusCapture.h"
+#include "criticalSection.h"
+#include "cycles64.h"
+
+namespace MMT
+{
+    namespace // private
+    {
+        constexpr unsigned busShift   = 4;        // G0..G7 = GPIO7 bits 4..11
+        constexpr uint32_t maxRun     = 0xFF'FFFF; // 24 bit run length
+        constexpr uint32_t startDelay = 200;      // cycles between the setup and the first sample
+    }
+
+    BusCapture::BusCapture(uint32_t* _buffer, size_t _words)
+        : buffer(_buffer), words(_words)
+    {
+    }
+
+    bool BusCapture::capture(const CaptureConfig& config)
+    {
+        cycles64::begin();
+
+        rle       = config.rle;
+        period_   = config.sampleRate > 0 ? (uint32_t)(F_CPU / config.sampleRate + 0.5f) : 1;
+        if (period_ == 0) period_ = 1;
+        wrapped   = false;
+        writeIdx  = 0;
+        trigger   = UINT32_MAX;
+        overruns_ = 0;
+
+        // trigger timeout in samples, blocked captures (waiting + sampling) need to fit into maxBlockedCycles
+        float rate              = (float)F_CPU / period_;
+        float timeout           = config.timeout > 0 ? config.timeout * rate : 0;
+        uint32_t timeoutSamples = timeout < (float)UINT32_MAX ? (uint32_t)timeout : UINT32_MAX;
+        uint32_t samples        = config.samples;
+        if (config.blockInterrupts)
+        {
+            uint32_t budget = maxBlockedCycles / period_;
+            if (samples > budget) samples = budget;
+            if (timeoutSamples > budget - samples) timeoutSamples = budget - samples;
+        }
+
+        auto sample = [&] {
+            if (rle)
+                run<true>(config, timeoutSamples, samples);
+            else
+                run<false>(config, timeoutSamples, samples);
+        };
+        if (config.blockInterrupts)
+        {
+            CriticalSection cs;
+            sample();
+        }
+        else
+        {
+            sample();
+        }
+
+        // index of the oldest retained sample
+        if (!wrapped)
+        {
+            first = 0;
+        }
+        else if (!rle)
+        {
+            first = total - size();
+        }
+        else
+        {
+            uint32_t retained = 0;
+            for (size_t i = 0; i < words; i++) retained += buffer[i] >> 8;
+            first = total - retained;
+        }
+        return trigger != UINT32_MAX;
+    }
+
+    template <bool encode>
+    FASTRUN void BusCapture::run(const CaptureConfig& config, uint32_t timeoutSamples, uint32_t samples)
+    {
+        uint8_t* bytes        = (uint8_t*)buffer;
+        const size_t capacity = size();
+        const uint32_t mask   = config.triggerMask;
+        const uint32_t value  = config.triggerValue & mask;
+        const uint32_t period = period_;
+
+        size_t w           = 0;
+        bool wrap          = false;
+        bool waiting       = mask != 0;
+        uint32_t remaining = waiting ? timeoutSamples : samples;
+        uint32_t n         = 0;
+        uint32_t late      = 0;
+        uint32_t runValue  = 0;
+        uint32_t runLength = 0;
+
+        if (!waiting) trigger = 0;
+        if (capacity == 0 || remaining == 0)
+        {
+            total = duration = 0;
+            return;
+        }
+
+        start             = cycles64::get() + startDelay; // the low word of cycles64 equals ARM_DWT_CYCCNT
+        uint32_t next     = (uint32_t)start;
+        uint32_t deadline = next + maxBlockedCycles;
+
+        while (remaining != 0)
+        {
+            if ((int32_t)(ARM_DWT_CYCCNT - next) > 0) // the previous sample took longer than a period
+            {
+                late++;
+                if (config.blockInterrupts && (int32_t)(ARM_DWT_CYCCNT - deadline) > 0) break; // can't keep up, stop before cycles64 breaks
+            }
+            while ((int32_t)(ARM_DWT_CYCCNT - next) < 0) {}
+            uint32_t v = (GPIO7_PSR >> busShift) & 0xFF;
+            next += period;
+
+            if (encode)
+            {
+                if (v == runValue && runLength < maxRun)
+                {
+                    runLength++;
+                }
+                else
+                {
+                    if (runLength != 0)
+                    {
+                        buffer[w] = (runLength << 8) | runValue;
+                        if (++w == capacity) { w = 0; wrap = true; }
+                    }
+                    runValue  = v;
+                    runLength = 1;
+                }
+            }
+            else
+            {
+                bytes[w] = v;
+                if (++w == capacity) { w = 0; wrap = true; }
+            }
+
+            if (waiting && (v & mask) == value)
+            {
+                waiting   = false;
+                trigger   = n;
+                remaining = samples;
+            }
+            n++;
+            remaining--;
+        }
+
+        if (encode && runLength != 0) // pending run
+        {
+            buffer[w] = (runLength << 8) | runValue;
+            if (++w == capacity) { w = 0; wrap = true; }
+        }
+
+        duration  = cycles64::get() - start;
+        total     = n;
+        writeIdx  = w;
+        wrapped   = wrap;
+        overruns_ = late;
+    }
+
+    int32_t BusCapture::triggerSample() const
+    {
+        if (trigger == UINT32_MAX || trigger < first) return -1;
+        return trigger - first;
+    }
+
+    size_t BusCapture::write(Stream& stream) const
+    {
+        CaptureHeader h;
+        h.magic         = captureMagic;
+        h.version       = 1;
+        h.rle           = rle;
+        h.reserved      = 0;
+        h.cpuFrequency  = F_CPU;
+        h.period        = period_;
+        h.firstSample   = firstSample();
+        h.samples       = samples();
+        h.entries       = entries();
+        h.triggerSample = triggerSample();
+        h.overruns      = overruns_;
+
+        const uint8_t* data = (const uint8_t*)buffer;
+        size_t entrySize    = rle ? sizeof(uint32_t) : 1;
+        size_t n            = stream.write((const uint8_t*)&h, sizeof(h));
+        if (wrapped) // oldest entry at writeIdx
+        {
+            n += stream.write(data + writeIdx * entrySize, (size() - writeIdx) * entrySize);
+        }
+        n += stream.write(data, writeIdx * entrySize);
+        return n;
+    }
+
+    float BusCapture::maxSampleRate(bool rle)
+    {
+        constexpr uint32_t nrOfSamples = 2000;
+        uint32_t scratch[256];
+
+        CaptureConfig cfg;
+        cfg.sampleRate = F_CPU; // one cycle per sample, i.e. each sample is taken as early as possible
+        cfg.rle        = rle;
+        cfg.samples    = nrOfSamples;
+
+        BusCapture cap(scratch);
+        cap.capture(cfg);
+        if (cap.total == 0) return 0;
+
+        // the free running throughput is only an estimate, a paced loop has to exit the wait loop
+        // but skips the lateness handling. Start there and search for the shortest period a
+        // capture keeps up with, i.e. reports no overruns.
+        auto keepsUp = [&](uint32_t period) {
+            cfg.sampleRate = (float)F_CPU / period;
+            cap.capture(cfg);
+            return cap.overruns_ == 0;
+        };
+
+        uint32_t period = cap.duration / cap.total;
+        if (period == 0) period = 1;
+        while (!keepsUp(period))
+        {
+            period += 1 + period / 16; // coarser steps for slow loops
+            if (period > F_CPU / 1000) return 0;
+        }
+        while (period > 1 && keepsUp(period - 1)) period--;
+        return (float)F_CPU / period;
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+/************************************************************************************
+ * Logic analyzer mode for the MicroMod BUS (G0..G7)
+ *
+ * Samples GPIO7_PSR at a fixed rate in a cycle counted loop and stores the samples
+ * into a ring buffer, either raw (1 byte per sample) or run length encoded (one word
+ * per run of unchanged samples: bits 0-7 value, bits 8-31 number of samples).
+ * The ring keeps the history before the trigger, i.e. after the capture the buffer
+ * contains the last samples before the trigger followed by the post trigger samples.
+ *
+ * Sample n was taken at firstSample() + n * period() (cycles64 time). Samples which
+ * had to be taken late, because the loop couldn't keep up, are counted in overruns().
+ * maxSampleRate(rle) measures the highest rate without overruns: it starts at the free
+ * running loop throughput and searches for the shortest period at which test captures
+ * report no overruns.
+ *
+ *   DMAMEM uint32_t buf[32 * 1024];
+ *   MMT::BusCapture cap(buf);
+ *
+ *   MMT::CaptureConfig cfg;
+ *   cfg.sampleRate   = 10E6;
+ *   cfg.samples      = 50'000;
+ *   cfg.triggerMask  = 0x01; // G0 high
+ *   cfg.triggerValue = 0x01;
+ *   cap.capture(cfg);
+ *   cap.write(Serial); // convert with captureToVcd.py and open in PulseView or GTKWave
+ *
+ * capture() blocks. With blockInterrupts (default) the timing is exact, but USB,
+ * timers etc. stop during the capture. The cycles64 extension then only survives
+ * captures shorter than ~2.5s (maxBlockedCycles). capture() shortens the trigger
+ * timeout, and if that's not enough the number of samples, to stay below this limit.
+ * It also stops if the loop can't keep up with the sample rate for that long.
+ ************************************************************************************/
+
+#include "Arduino.h"
+
+namespace MMT
+{
+    struct CaptureConfig
+    {
+        float sampleRate     = 1E6;        // Hz
+        bool rle             = true;       // run length encode unchanged samples
+        uint32_t samples     = 10'000;     // number of samples taken after the trigger (including the trigger sample)
+        uint8_t triggerMask  = 0;          // triggers when (bus & triggerMask) == triggerValue. Mask 0: triggers on the first sample
+        uint8_t triggerValue = 0;
+        float timeout        = 1.0f;       // max time to wait for the trigger (s)
+        bool blockInterrupts = true;
+    };
+
+    class BusCapture
+    {
+     public:
+        BusCapture(uint32_t* buffer, size_t words);
+
+        template <size_t N>
+        BusCapture(uint32_t (&buffer)[N])
+            : BusCapture(buffer, N) {}
+
+        bool capture(const CaptureConfig& config); // false on timeout, the buffer then holds the last samples before the timeout
+
+        uint64_t firstSample() const { return start + (uint64_t)first * period_; } // cycles64 time of the oldest retained sample
+        uint32_t period() const { return period_; }                                // cycles between samples
+        uint32_t samples() const { return total - first; }                         // number of retained samples
+        uint32_t overruns() const { return overruns_; }
+        int32_t triggerSample() const;                                             // relative to the first retained sample, -1: no trigger or overwritten
+        size_t entries() const { return wrapped ? size() : writeIdx; }             // used bytes (raw) or words (rle)
+
+        size_t write(Stream& stream) const; // binary dump, see captureToVcd.py
+
+        static float maxSampleRate(bool rle); // highest rate without overruns, measured on the current bus activity, 0: none found
+
+        static constexpr uint32_t maxBlockedCycles = (1u << 31) - F_CPU; // cycles64 needs a get() every 2^31 cycles, the last RTC tick can be up to 1s ago
+
+     private:
+        template <bool encode>
+        void run(const CaptureConfig& config, uint32_t timeoutSamples, uint32_t samples);
+        size_t size() const { return rle ? words : words * sizeof(uint32_t); }
+
+        uint32_t* buffer;
+        size_t words;
+
+        bool rle           = true;
+        bool wrapped       = false;
+        size_t writeIdx    = 0;
+        uint64_t start     = 0; // cycles64 time of sample 0
+        uint32_t period_   = 0;
+        uint32_t total     = 0; // number of taken samples
+        uint32_t first     = 0; // index of the oldest retained sample
+        uint32_t trigger   = UINT32_MAX;
+        uint32_t overruns_ = 0;
+        uint64_t duration  = 0; // cycles from the first to the last sample
+    };
+
+    struct __attribute__((packed)) CaptureHeader
+    {
+        uint32_t magic;         // captureMagic
+        uint8_t version;        // 1
+        uint8_t rle;            // 0: one byte per sample, 1: one little endian word per run
+        uint16_t reserved;
+        uint32_t cpuFrequency;  // F_CPU
+        uint32_t period;        // cycles between samples
+        uint64_t firstSample;   // cycles64 time of the first sample
+        uint32_t samples;
+        uint32_t entries;       // number of bytes (raw) or words (rle) following the header
+        int32_t triggerSample;  // relative to the first sample, -1: none
+        uint32_t overruns;
+    };
+    static_assert(sizeof(CaptureHeader) == 40, "unexpected header size");
+
+    constexpr uint32_t captureMagic = 0x4342'4D4D; // 'M' 'M' 'B' 'C'
+}
@@ -1,9 +1,68 @@
 #include "MicroModT4.h"
+#include "DMAChannel.h"
 
 namespace MMT
 {
+    namespace // private
+    {
+        constexpr uint32_t busMask  = 0xFF << 4; // G0..G7 = GPIO7 bits 4..11
+        constexpr unsigned busShift = 4;
+
+        volatile uint32_t* strobeSet   = nullptr;
+        volatile uint32_t* strobeClear = nullptr;
+        uint32_t strobeMask            = 0;
+
+        constexpr uint32_t pitClock   = 24'000'000; // PIT runs from the 24MHz oscillator (PERCLK, set up by the core)
+        constexpr uint32_t minPitTicks = 4;          // -> 6MB/s max, leaves the DMA enough time to reach GPIO2
+
+        bool dmaActive = false;
+        int pitChannel = -1;
+
+        DMAChannel& dma() // allocated on the first writeDMA, sketches which don't use it don't lose a channel
+        {
+            static DMAChannel channel;
+            return channel;
+        }
+
+        int freePitChannel() // first PIT channel which isn't used, same check as IntervalTimer
+        {
+            for (int ch = 0; ch < 4; ch++)
+            {
+                if (IMXRT_PIT_CHANNELS[ch].TCTRL == 0) return ch;
+            }
+            return -1;
+        }
+
+        void routePitToDma() // PIT trigger -> XBAR1 -> DMA request DMAMUX_SOURCE_XBAR1_0
+        {
+            CCM_CCGR2 |= CCM_CCGR2_XBAR1(CCM_CCGR_ON);
+            volatile uint16_t* sel = &XBARA1_SEL0 + XBARA1_OUT_DMA_CH_MUX_REQ30 / 2;
+            uint16_t input         = XBARA1_IN_PIT_TRIGGER0 + pitChannel;
+            *sel                   = (XBARA1_OUT_DMA_CH_MUX_REQ30 & 1) ? (*sel & 0x00FF) | (input << 8) : (*sel & 0xFF00) | input;
+            XBARA1_CTRL0           = XBARA_CTRL_STS0 | XBARA_CTRL_EDGE0(1) | XBARA_CTRL_DEN0; // request on rising edges
+        }
+
+        void releaseDMA()
+        {
+            IMXRT_PIT_CHANNELS[pitChannel].TCTRL = 0;           // free the PIT channel
+            pitChannel                           = -1;
+            GPIO7_DR_TOGGLE = (GPIO7_DR ^ GPIO2_DR) & busMask; // take over the last value...
+            IOMUXC_GPR_GPR27 |= busMask;                       // ...and switch the pins back to the fast GPIO7
+            dmaActive = false;
+        }
+
+        inline void waitForDMA() // the pins are on GPIO2 during a DMA transfer, GPIO7 writes would be lost
+        {
+            if (!dmaActive) return;
+            while (!dma().complete()) {}
+            dma().clearComplete();
+            releaseDMA();
+        }
+    }
+
     void BUS::pinMode(int mode) const
     {
+        waitForDMA();
         for (uint8_t pin : {G0, G1, G2, G3, G4, G5, G6, G7})
         {
             ::pinMode(pin, mode);
@@ -12,9 +71,94 @@ namespace MMT
 
     void BUS::operator=(uint8_t value) const
     {
-        noInterrupts();      
-        GPIO7_DR           = (GPIO7_DR & ~(0xFF << 4)) | (((uint32_t)value) << 4);
-        interrupts();
+        waitForDMA();
+        GPIO7_DR_TOGGLE = (GPIO7_DR ^ (((uint32_t)value) << busShift)) & busMask; // only toggles the changed bus bits, other pins of GPIO7 are not touched
+    }
+
+    void BUS::setStrobe(int pin, bool activeHigh)
+    {
+        if (pin < 0)
+        {
+            strobeMask = 0;
+            return;
+        }
+        ::pinMode(pin, OUTPUT);
+        strobeMask  = digitalPinToBitMask(pin);
+        strobeSet   = activeHigh ? portSetRegister(pin) : portClearRegister(pin);
+        strobeClear = activeHigh ? portClearRegister(pin) : portSetRegister(pin);
+        *strobeClear = strobeMask; // inactive
+    }
+
+    void BUS::write(const uint8_t* data, size_t len) const
+    {
+        waitForDMA();
+        uint32_t last = GPIO7_DR & busMask;
+        for (size_t i = 0; i < len; i++)
+        {
+            uint32_t next   = ((uint32_t)data[i]) << busShift;
+            GPIO7_DR_TOGGLE = last ^ next;
+            last            = next;
+
+            if (strobeMask)
+            {
+                *strobeSet   = strobeMask;
+                *strobeClear = strobeMask;
+            }
+        }
+    }
+
+    bool BUS::writeDMA(const uint8_t* data, size_t len, uint32_t* buffer, uint32_t bytesPerSecond)
+    {
+        if (len == 0 || len > 32767 || bytesPerSecond == 0) return false;
+        uint32_t ticks = (pitClock + bytesPerSecond / 2) / bytesPerSecond;
+        if (ticks < minPitTicks) return false;
+
+        waitForDMA(); // a previous transfer
+        pitChannel = freePitChannel();
+        if (pitChannel < 0) return false;
+
+        // the DMA writes toggle masks, i.e. other pins of the port are not affected
+        uint32_t last = GPIO7_DR & busMask;
+        for (size_t i = 0; i < len; i++)
+        {
+            uint32_t next = ((uint32_t)data[i]) << busShift;
+            buffer[i]     = last ^ next;
+            last          = next;
+        }
+        arm_dcache_flush(buffer, len * sizeof(uint32_t));
+
+        // DMA can't access the fast GPIOs -> hand the pins over to GPIO2 without glitches
+        GPIO2_DR_TOGGLE = (GPIO2_DR ^ GPIO7_DR) & busMask;
+        GPIO2_GDIR      = (GPIO2_GDIR & ~busMask) | (GPIO7_GDIR & busMask);
+        IOMUXC_GPR_GPR27 &= ~busMask;
+        dmaActive = true;
+
+        // one word per PIT period, the first one a period after the start
+        routePitToDma();
+        DMAChannel& ch = dma();
+        ch.begin();
+        ch.sourceBuffer(buffer, len * sizeof(uint32_t));
+        ch.destination(GPIO2_DR_TOGGLE);
+        ch.transferCount(len);
+        ch.disableOnCompletion();
+        ch.triggerAtHardwareEvent(DMAMUX_SOURCE_XBAR1_0);
+        ch.enable();
+
+        CCM_CCGR1 |= CCM_CCGR1_PIT(CCM_CCGR_ON);
+        PIT_MCR                              = 0;
+        IMXRT_PIT_CHANNELS[pitChannel].LDVAL = ticks - 1;
+        IMXRT_PIT_CHANNELS[pitChannel].TCTRL = PIT_TCTRL_TEN; // no interrupt, only the trigger output
+        return true;
+    }
+
+    bool BUS::dmaBusy()
+    {
+        if (!dmaActive) return false;
+        if (!dma().complete()) return true;
+
+        dma().clearComplete();
+        releaseDMA();
+        return false;
     }
 
     BUS::operator uint8_t() const
@@ -95,13 +95,36 @@ namespace MMT
     // Misc
     constexpr uint8_t BATT_VIN = A8;
 
+    // 8 bit bus G0..G7
+    //
+    // Writes only toggle the changed bus bits of GPIO7 (read DR, write DR_TOGGLE). Other GPIO7 pins
+    // can be written from interrupts at any time. The bus itself must only be written from one
+    // context, a write from an interrupt between the read and the toggle would be corrupted.
+    //
+    // Host simulation figures (bench_bus.cpp): bus.operator=, bus.write and bus.writeDMA in MB/s.
+    // They compare the three paths, the absolute values don't predict the throughput on the board.
+    // bus.writeDMA.rate is the PIT paced rate in simulated time (3MB/s requested), this one holds on the board.
     class BUS
     {
      public:
-        void operator=(uint8_t value) const;
+        void operator=(uint8_t value) const;                             // glitch free single write, doesn't disable interrupts
         operator uint8_t() const;
         void pinMode(int mode) const;
 
+        void setStrobe(int pin, bool activeHigh = true);                 // pin pulsed after each byte of a block write (-1: no strobe)
+        void write(const uint8_t* data, size_t len) const;               // block write
+
+        // DMA block write (no strobe). buffer needs to hold len words and must stay valid until the transfer is done.
+        // During the transfer the bus pins are switched from the fast GPIO7 to GPIO2 which can be accessed by the DMA.
+        // operator=, write, pinMode and writeDMA wait until a running transfer is done before they touch the pins.
+        //
+        // Each byte is triggered by a free PIT channel (routed through XBAR1 to DMAMUX_SOURCE_XBAR1_0). The actual
+        // rate is 24MHz / n with n = round(24MHz / bytesPerSecond), e.g. 1MB/s: n = 24, 3MB/s: n = 8, 5MB/s: n = 5
+        // (4.8MB/s). n >= 4, i.e. 6MB/s max. Returns false for rates above that or if all 4 PIT channels are in use.
+        // The DMA channel is allocated on the first call, the PIT channel is released when the transfer is done.
+        bool writeDMA(const uint8_t* data, size_t len, uint32_t* buffer, uint32_t bytesPerSecond = 1'000'000);
+        bool dmaBusy();                                                  // switches the pins back to GPIO7 when done
+
         static BUS& getInstance()
         {
             static BUS instance;
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+Converts a binary MicroMod BUS capture (MMT::BusCapture::write) to a VCD file.
+
+usage: captureToVcd.py capture.bin [capture.vcd]
+
+Capture the stream e.g. with 'cat /dev/ttyACM0 > capture.bin' and open the generated
+vcd file in PulseView or GTKWave. The file contains the single lines G0..G7 and the
+8 bit vector 'bus'. Times are relative to the first sample, the trigger is marked by
+the 'trigger' line.
+"""
+import struct
+import sys
+
+MAGIC = 0x43424D4D
+HEADER = struct.Struct("<IBBHIIQIIiI")
+SIGNALS = [f"G{i}" for i in range(8)]
+
+
+def readCapture(data):
+    if len(data) < HEADER.size:
+        raise ValueError("file too short")
+    (magic, version, rle, _, fcpu, period, first, samples, entries, trigger, overruns) = HEADER.unpack_from(data)
+    if magic != MAGIC or version != 1:
+        raise ValueError("not a BusCapture file")
+
+    payload = data[HEADER.size :]
+    runs = []  # (first sample, value)
+    if rle:
+        n = 0
+        for (word,) in struct.iter_unpack("<I", payload[: entries * 4]):
+            runs.append((n, word & 0xFF))
+            n += word >> 8
+    else:
+        last = None
+        for n, value in enumerate(payload[:entries]):
+            if value != last:
+                runs.append((n, value))
+                last = value
+    return {"fcpu": fcpu, "period": period, "first": first, "samples": samples, "trigger": trigger, "overruns": overruns, "runs": runs}
+
+
+def writeVcd(cap, f):
+    ps = lambda n: round(n * cap["period"] * 1e12 / cap["fcpu"])  # sample index -> ps
+
+    ids = {name: chr(ord("!") + i) for i, name in enumerate(SIGNALS)}
+    ids["bus"], ids["trigger"] = "*", "+"
+
+    f.write("$comment MicroMod BUS capture, first sample at cycle %d, %d overruns $end\n" % (cap["first"], cap["overruns"]))
+    f.write("$timescale 1 ps $end\n$scope module bus $end\n")
+    for name in SIGNALS:
+        f.write(f"$var wire 1 {ids[name]} {name} $end\n")
+    f.write(f"$var wire 8 {ids['bus']} bus $end\n$var wire 1 {ids['trigger']} trigger $end\n")
+    f.write("$upscope $end\n$enddefinitions $end\n")
+
+    events = {}
+    last = None
+    for n, value in cap["runs"]:
+        changes = []
+        for bit, name in enumerate(SIGNALS):
+            if last is None or (value ^ last) >> bit & 1:
+                changes.append(f"{value >> bit & 1}{ids[name]}")
+        changes.append(f"b{value:08b} {ids['bus']}")
+        events.setdefault(ps(n), []).extend(changes)
+        last = value
+
+    events.setdefault(0, []).append(f"0{ids['trigger']}")
+    if cap["trigger"] >= 0:
+        events.setdefault(ps(cap["trigger"]), []).append(f"1{ids['trigger']}")
+
+    for t in sorted(events):
+        f.write(f"#{t}\n" + "\n".join(events[t]) + "\n")
+    f.write(f"#{ps(cap['samples'])}\n")
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        cap = readCapture(f.read())
+
+    out = sys.argv[2] if len(sys.argv) > 2 else sys.argv[1].rsplit(".", 1)[0] + ".vcd"
+    with open(out, "w") as f:
+        writeVcd(cap, f)
+
+    rate = cap["fcpu"] / cap["period"]
+    print(f"{cap['samples']} samples @ {rate / 1e6:.3f} MHz, {len(cap['runs'])} runs -> {out}" + (f" ({cap['overruns']} overruns)" if cap["overruns"] else ""))
+
+
+if __name__ == "__main__":
+    main()
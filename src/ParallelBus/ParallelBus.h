@@ -0,0 +1,197 @@
+#pragma once
+/************************************************************************************
+ * Compile time generated parallel bus on arbitrary pins of one fast GPIO port (T4.x)
+ *
+ *   ParallelBus<40, 41, 42, 43, 44, 45, 6, 9> bus;   // pins in bit order, LSB first
+ *   bus.pinMode(OUTPUT);
+ *   bus = 0x42;
+ *   uint8_t val = bus;
+ *
+ * Port, mask and shift are computed at compile time. If the pins occupy consecutive
+ * ascending bits of the port, read and write compile to a single register access plus
+ * shift/mask. Otherwise the bits are scattered/gathered with precomputed masks.
+ * Writes read DR and write the changed bits to DR_TOGGLE, i.e. all pins change at the
+ * same time and other pins of the port are not affected. The read and the toggle are
+ * done under a CriticalSection, interrupts which write other pins of the port in between
+ * would otherwise be undone. Pins on different ports don't compile.
+ *
+ * check(): compares the built in pin table with the one of the core (for debugging)
+ ************************************************************************************/
+
+#include "Arduino.h"
+#include "criticalSection.h"
+#include <initializer_list>
+#include <type_traits>
+
+namespace ParallelBusDetail
+{
+    struct PinInfo
+    {
+        uint8_t port; // fast GPIO port 6..9, 0: invalid pin
+        uint8_t bit;
+    };
+
+    constexpr PinInfo pinInfo(unsigned pin)
+    {
+        constexpr PinInfo table[] = {
+            {6, 3}, {6, 2}, {9, 4}, {9, 5}, {9, 6}, {9, 8}, {7, 10}, {7, 17}, {7, 16}, {7, 11},      //  0 -  9
+            {7, 0}, {7, 2}, {7, 1}, {7, 3}, {6, 18}, {6, 19}, {6, 23}, {6, 22}, {6, 17}, {6, 16},    // 10 - 19
+            {6, 26}, {6, 27}, {6, 24}, {6, 25}, {6, 12}, {6, 13}, {6, 30}, {6, 31}, {8, 18}, {9, 31}, // 20 - 29
+            {8, 23}, {8, 22}, {7, 12}, {9, 7},                                                        // 30 - 33
+#if defined(ARDUINO_TEENSY41)
+            {7, 29}, {7, 28}, {7, 18}, {7, 19}, {6, 28}, {6, 29}, {6, 20}, {6, 21}, {8, 15}, {8, 14}, // 34 - 43
+            {8, 13}, {8, 12}, {8, 17}, {8, 16}, {9, 24}, {9, 27}, {9, 28}, {9, 22}, {9, 26}, {9, 25}, // 44 - 53
+            {9, 29},                                                                                  // 54
+#elif defined(ARDUINO_TEENSY_MICROMOD)
+            {8, 15}, {8, 14}, {8, 13}, {8, 12}, {8, 16}, {8, 17},                                     // 34 - 39
+            {7, 4}, {7, 5}, {7, 6}, {7, 7}, {7, 8}, {7, 9},                                           // 40 - 45
+#else // T4.0
+            {8, 15}, {8, 14}, {8, 13}, {8, 12}, {8, 17}, {8, 16},                                     // 34 - 39
+#endif
+        };
+        return pin < sizeof(table) / sizeof(table[0]) ? table[pin] : PinInfo{0, 0};
+    }
+
+    constexpr uint8_t first(std::initializer_list<uint8_t> pins)
+    {
+        return *pins.begin();
+    }
+
+    constexpr bool valid(std::initializer_list<uint8_t> pins)
+    {
+        for (uint8_t p : pins)
+        {
+            if (pinInfo(p).port == 0) return false;
+        }
+        return true;
+    }
+
+    constexpr bool samePort(std::initializer_list<uint8_t> pins)
+    {
+        for (uint8_t p : pins)
+        {
+            if (pinInfo(p).port != pinInfo(first(pins)).port) return false;
+        }
+        return true;
+    }
+
+    constexpr bool unique(std::initializer_list<uint8_t> pins)
+    {
+        uint32_t mask = 0;
+        for (uint8_t p : pins)
+        {
+            uint32_t m = 1UL << pinInfo(p).bit;
+            if (mask & m) return false;
+            mask |= m;
+        }
+        return true;
+    }
+
+    constexpr uint32_t mask(std::initializer_list<uint8_t> pins)
+    {
+        uint32_t m = 0;
+        for (uint8_t p : pins) m |= 1UL << pinInfo(p).bit;
+        return m;
+    }
+
+    constexpr bool contiguous(std::initializer_list<uint8_t> pins)
+    {
+        unsigned expected = pinInfo(first(pins)).bit;
+        for (uint8_t p : pins)
+        {
+            if (pinInfo(p).bit != expected++) return false;
+        }
+        return true;
+    }
+}
+
+template <uint8_t... pins>
+class ParallelBus
+{
+    static_assert(sizeof...(pins) > 0 && sizeof...(pins) <= 32, "a ParallelBus needs 1 to 32 pins");
+    static_assert(ParallelBusDetail::valid({pins...}), "ParallelBus: pin has no fast GPIO on this board");
+    static_assert(ParallelBusDetail::samePort({pins...}), "ParallelBus: all pins need to be on the same GPIO port");
+    static_assert(ParallelBusDetail::unique({pins...}), "ParallelBus: duplicate pins");
+
+ public:
+    using value_t = typename std::conditional<(sizeof...(pins) <= 8), uint8_t, typename std::conditional<(sizeof...(pins) <= 16), uint16_t, uint32_t>::type>::type;
+
+    static constexpr unsigned port      = ParallelBusDetail::pinInfo(ParallelBusDetail::first({pins...})).port;
+    static constexpr uint32_t mask      = ParallelBusDetail::mask({pins...});
+    static constexpr bool contiguous    = ParallelBusDetail::contiguous({pins...});
+    static constexpr unsigned shift     = __builtin_ctz(mask);
+    static constexpr unsigned width     = sizeof...(pins);
+
+    static void pinMode(int mode)
+    {
+        for (uint8_t pin : {pins...}) ::pinMode(pin, mode);
+        useFastGPIO();
+    }
+
+    static void useFastGPIO() // route the pins to the fast GPIO port (default after startup)
+    {
+        gpr() |= mask;
+    }
+
+    static void write(value_t value)
+    {
+        uint32_t bits = scatter(value);
+        CriticalSection cs;
+        reg(0x8C) = (reg(0x00) ^ bits) & mask; // DR_TOGGLE: single access, only changed bits toggle
+    }
+
+    static value_t read()
+    {
+        return gather(reg(0x08)); // PSR
+    }
+
+    static void set() { reg(0x84) = mask; }                            // DR_SET
+    static void clear() { reg(0x88) = mask; }                          // DR_CLEAR
+
+    void operator=(value_t value) const { write(value); }
+    operator value_t() const { return read(); }
+
+    static bool check()
+    {
+        for (uint8_t pin : {pins...})
+        {
+            auto info = ParallelBusDetail::pinInfo(pin);
+            if (digital_pin_to_info_PGM[pin].mask != (1UL << info.bit)) return false;
+            if (digital_pin_to_info_PGM[pin].reg != &reg(0)) return false;
+        }
+        return true;
+    }
+
+ protected:
+    static constexpr uintptr_t base       = 0x4200'0000 + (port - 6) * 0x4000;                    // GPIO6_DR ... GPIO9_DR
+    static constexpr uintptr_t gprAddress = 0x400A'C068 + (port - 6) * 4;                         // IOMUXC_GPR_GPR26 ... GPR29
+
+#if defined(ARDUINO_TEENSY_SIM)
+    static volatile uint32_t& reg(uintptr_t offset) { return *sim::reg(base + offset); }
+    static volatile uint32_t& gpr() { return *sim::reg(gprAddress); }
+#else
+    static volatile uint32_t& reg(uintptr_t offset) { return *(volatile uint32_t*)(base + offset); }
+    static volatile uint32_t& gpr() { return *(volatile uint32_t*)gprAddress; }
+#endif
+
+    static constexpr uint32_t scatter(uint32_t value) { return contiguous ? (value << shift) & mask : scatterBits<pins...>(value, 0); }
+    static constexpr value_t gather(uint32_t portValue) { return contiguous ? (value_t)((portValue & mask) >> shift) : (value_t)gatherBits<pins...>(portValue, 0); }
+
+    template <uint8_t pin, uint8_t... rest>
+    static constexpr uint32_t scatterBits(uint32_t value, unsigned i)
+    {
+        return (((value >> i) & 1) << ParallelBusDetail::pinInfo(pin).bit) | scatterBits<rest...>(value, i + 1);
+    }
+
+    template <uint8_t pin, uint8_t... rest>
+    static constexpr uint32_t gatherBits(uint32_t portValue, unsigned i)
+    {
+        return (((portValue >> ParallelBusDetail::pinInfo(pin).bit) & 1) << i) | gatherBits<rest...>(portValue, i + 1);
+    }
+
+    template <typename... none>
+    static constexpr uint32_t scatterBits(uint32_t, unsigned) { return 0; }
+
+    template <typename... none>
+    static constexpr uint32_t gatherBits(uint32_t, unsigned) { return 0; }
+};
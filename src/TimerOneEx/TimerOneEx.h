@@ -1,9 +1,65 @@
 #pragma once
 
 #include "TimerOne.h"
+#include "criticalSection.h"
 
-template <typename T>
-class TimerOneEx : public TimerOne
+/**
+ * Small delegate which binds an object and a member function (or any callable) without
+ * std::function or heap usage. The member function is a template parameter, i.e. the
+ * generated thunk calls it directly.
+ */
+struct TimerDelegate
+{
+    void* object         = nullptr;
+    void (*thunk)(void*) = nullptr;
+
+    void operator()() const
+    {
+        if (thunk) thunk(object);
+    }
+
+    template <class U, void (U::*member)()>
+    static TimerDelegate bind(U* obj)
+    {
+        return {obj, [](void* o) { (static_cast<U*>(o)->*member)(); }};
+    }
+
+    template <class Callable> // lambdas, functors... The callable needs to outlive the binding
+    static TimerDelegate bind(Callable& callable)
+    {
+        return {&callable, [](void* o) { (*static_cast<Callable*>(o))(); }};
+    }
+
+    template <class Callable>
+    static TimerDelegate bind(const Callable& callable)
+    {
+        return {const_cast<Callable*>(&callable), [](void* o) { (*static_cast<const Callable*>(o))(); }};
+    }
+
+    template <class Callable>
+    static TimerDelegate bind(const Callable&& callable) = delete; // would dangle, bind a named object
+};
+
+/**
+ * TimerOneEx<T> allows member functions of T as timer callbacks.
+ * Several objects of the same class can use it, each TimerOneEx object can bind a different
+ * object and member. The active binding however is stored once per <T, Timer> (static
+ * active()): attaching through one TimerOneEx<T, Timer> replaces the binding of all others.
+ * Since there is only one hardware timer, only the last attached callback is called anyway.
+ * Other timers with the TimerOne interface (e.g. TimerThree) can be passed as second parameter.
+ *
+ * attachInterrupt(&T::member, obj):   member function pointer at runtime (as before)
+ * attachInterrupt<&T::member>(obj):   member known at compile time, direct call in the thunk
+ * attachInterrupt<obj, &T::member>(): object and member known at compile time,
+ *                                     the timer isr calls the member directly (zero overhead)
+ * attachInterrupt(callable):          lambdas or functors (also const), need to outlive the binding
+ *
+ * Latency from the timer isr to the callback: bench_timerOneEx.cpp compares the variants with
+ * a plain function attached to the timer. The delegate costs one indirect call (thunk), the
+ * runtime member pointer an additional one, attachInterrupt<obj, &T::member>() nothing.
+ */
+template <typename T, class Timer = TimerOne>
+class TimerOneEx : public Timer
 {
  public:
     using callback_t = void (T::*)();
@@ -14,29 +70,72 @@ class TimerOneEx : public TimerOne
         object   = nullptr;
     }
 
-    void attachInterrupt(callback_t cb, T* obj) 
+    void attachInterrupt(callback_t cb, T* obj)
     {
         callback = cb;
         object   = obj;
-        TimerOne::attachInterrupt(relay);
+        bind({this, [](void* self) {
+                  TimerOneEx* THIS = static_cast<TimerOneEx*>(self);
+                  if (THIS->object) (THIS->object->*THIS->callback)();
+              }});
     }
 
+    template <void (T::*member)()>
+    void attachInterrupt(T* obj)
+    {
+        bind(TimerDelegate::bind<T, member>(obj));
+    }
+
+    template <T& obj, void (T::*member)()>
+    void attachInterrupt()
+    {
+        Timer::attachInterrupt(directRelay<obj, member>);
+    }
+
+    template <class Callable>
+    void attachInterrupt(Callable& callable)
+    {
+        bind(TimerDelegate::bind(callable));
+    }
+
+    template <class Callable>
+    void attachInterrupt(const Callable& callable)
+    {
+        bind(TimerDelegate::bind(callable));
+    }
+
+    template <class Callable>
+    void attachInterrupt(const Callable&& callable) = delete; // would dangle, attach a named object
+
  private:
-    static void relay()
+    void bind(TimerDelegate delegate)
     {
-        if (object) (*object.*callback)();
+        {
+            CriticalSection cs; // delegate consists of two words, the relay must not see a half written one
+            active() = delegate;
+        }
+        Timer::attachInterrupt(relay);
     }
 
-    static callback_t callback;
-    static T* object;
+    static TimerDelegate& active() // constant initialized, no guard variable
+    {
+        static TimerDelegate delegate;
+        return delegate;
+    }
 
-    using TimerOne::attachInterrupt; // don't shadow the orignal version
-};
+    static void relay()
+    {
+        active()();
+    }
 
-//instantiate static variables
+    template <T& obj, void (T::*member)()>
+    static void directRelay()
+    {
+        (obj.*member)();
+    }
 
-template <typename T>
-T* TimerOneEx<T>::object = nullptr;
+    callback_t callback;
+    T* object;
 
-template <typename T>
-typename TimerOneEx<T>::callback_t TimerOneEx<T>::callback = nullptr;
+    using Timer::attachInterrupt; // don't shadow the orignal version
+};
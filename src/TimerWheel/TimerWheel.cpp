@@ -0,0 +1,207 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel()
+{
+    for (auto& level : slots)
+    {
+        for (Node& slot : level)
+        {
+            slot.prev = slot.next = &slot; // empty circular list
+        }
+    }
+}
+
+TimerWheel::~TimerWheel()
+{
+    end();
+}
+
+bool TimerWheel::begin(duration tickPeriod)
+{
+    using namespace std::chrono;
+
+    tickCycles = tickPeriod.count();
+    if (tickCycles == 0) return false;
+
+    float us = duration_cast<std::chrono::duration<float, std::micro>>(tickPeriod).count();
+    return timer.begin([this] { tick(); }, us);
+}
+
+void TimerWheel::end()
+{
+    timer.end();
+}
+
+void TimerWheel::start(Timer& t, callback_t callback, duration delay)
+{
+    arm(t, std::move(callback), delay, duration(0));
+}
+
+void TimerWheel::startPeriodic(Timer& t, callback_t callback, duration period)
+{
+    arm(t, std::move(callback), period, period);
+}
+
+void TimerWheel::cancel(Timer& t)
+{
+    noInterrupts();
+    if (t.isActive())
+    {
+        unlink(&t);
+    }
+    if (running == &t) running = nullptr; // canceled, re-armed or destroyed from its own callback -> tick() must not touch it afterwards
+    interrupts();
+}
+
+// Interrupts are only enabled while a callback runs. Higher priority ISRs may
+// start or cancel timers at any time, including the ones in the expired list.
+void TimerWheel::tick()
+{
+    noInterrupts();
+    uint32_t cur = now;
+
+    if ((cur & slotMask) == 0) // level 0 wrapped -> move timers of the next slot of the higher levels down
+    {
+        for (unsigned level = 1; level < nrOfLevels; level++)
+        {
+            cascade(level);
+            if (((cur >> (levelBits * level)) & slotMask) != 0) break; // higher levels only need a cascade if this level wrapped as well
+        }
+    }
+
+    // detach the expired timers so that callbacks can safely start or cancel timers
+    Node expired;
+    Node* slot = &slots[0][cur & slotMask];
+    now        = cur + 1;
+    if (slot->next == slot)
+    {
+        interrupts();
+        return;
+    }
+    expired.next       = slot->next;
+    expired.prev       = slot->prev;
+    expired.next->prev = &expired;
+    expired.prev->next = &expired;
+    slot->next = slot->prev = slot;
+    interrupts();
+
+    while (true)
+    {
+        noInterrupts();
+        if (expired.next == &expired) break;
+
+        Timer* t = static_cast<Timer*>(expired.next);
+        unlink(t);
+        if (t->period != 0) // periodic -> rearm before calling back, the callback might cancel it
+        {
+            t->expires += t->period;
+            insert(*t);
+        }
+
+        // the callback might re-arm (replace t->callback) or destroy its own timer,
+        // so we call a local copy and only give it back if the timer was left alone
+        callback_t callback = std::move(t->callback);
+        running             = t;
+        interrupts();
+
+        callback();
+
+        noInterrupts();
+        if (running == t) t->callback = std::move(callback);
+        running = nullptr;
+        interrupts();
+    } // a dropped callback is destroyed here, with interrupts enabled
+    interrupts();
+}
+
+//----------------------------------------------------------------------------------
+
+void TimerWheel::arm(Timer& t, callback_t&& callback, duration delay, duration period)
+{
+    cancel(t);
+
+    t.wheel    = this;
+    t.callback = std::move(callback);
+    t.period   = period.count() == 0 ? 0 : toTicks(period);
+
+    noInterrupts();
+    t.expires = now + toTicks(delay);
+    insert(t);
+    interrupts();
+}
+
+// sorts the timer into its slot relative to the current tick. Interrupts need to be disabled
+void TimerWheel::insert(Timer& t)
+{
+    uint32_t expires = t.expires;
+    uint32_t delta   = expires - now;
+    Node* slot;
+
+    if (delta < nrOfSlots)
+    {
+        slot = &slots[0][expires & slotMask];
+    }
+    else if (delta < (1UL << (2 * levelBits)))
+    {
+        slot = &slots[1][(expires >> levelBits) & slotMask];
+    }
+    else if (delta < (1UL << (3 * levelBits)))
+    {
+        slot = &slots[2][(expires >> (2 * levelBits)) & slotMask];
+    }
+    else if (delta <= maxDelta)
+    {
+        slot = &slots[3][(expires >> (3 * levelBits)) & slotMask];
+    }
+    else // too far away (or already overdue), park it in the last slot of the top level, it will be re-sorted when cascaded
+    {
+        if ((int32_t)delta < 0)
+        {
+            slot = &slots[0][now & slotMask];
+        }
+        else
+        {
+            slot = &slots[3][((now >> (3 * levelBits)) + slotMask) & slotMask];
+        }
+    }
+    pushBack(slot, &t);
+}
+
+// re-sorts all timers of the current slot of the given level into the lower levels
+void TimerWheel::cascade(unsigned level)
+{
+    Node* slot = &slots[level][(now >> (levelBits * level)) & slotMask];
+
+    Node* node = slot->next;
+    slot->next = slot->prev = slot;
+
+    while (node != slot)
+    {
+        Node* next = node->next;
+        insert(*static_cast<Timer*>(node));
+        node = next;
+    }
+}
+
+uint32_t TimerWheel::toTicks(duration d) const
+{
+    uint64_t ticks = (d.count() + tickCycles - 1) / tickCycles; // round up, timers never fire early
+    if (ticks == 0) return 1;
+    if (ticks > UINT32_MAX / 2) return UINT32_MAX / 2;
+    return (uint32_t)ticks;
+}
+
+void TimerWheel::unlink(Node* node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node->next = nullptr;
+}
+
+void TimerWheel::pushBack(Node* list, Node* node)
+{
+    node->prev       = list->prev;
+    node->next       = list;
+    list->prev->next = node;
+    list->prev       = node;
+}
@@ -0,0 +1,93 @@
+#pragma once
+/************************************************************************************
+ * Hierarchical timing wheel which multiplexes an arbitrary number of software
+ * timers on a single IntervalTimerEx channel.
+ *
+ * The wheel has 4 levels of 64 slots. Level 0 resolves single ticks, each higher
+ * level covers 64 times the range of the one below. Timers are stored intrusively
+ * in doubly linked slot lists, i.e. starting and canceling a timer is O(1) and
+ * does not allocate memory. Timers further away than 64^4 ticks are parked in the
+ * last slot of the top level and re-sorted whenever they are cascaded down.
+ *
+ * begin(tick):       starts the underlying IntervalTimerEx with the given tick period
+ * start(t, cb, dt):  starts the one shot timer t which calls cb after dt
+ * startPeriodic(...) same, but cb is called every dt
+ * cancel(t):         stops the timer t
+ * tick():            advances the wheel by one tick (called from the timer ISR)
+ *
+ * Callbacks may start, cancel or destroy any timer, including their own. start() and
+ * cancel() may also be called from ISRs with a higher priority than the wheel timer.
+ *
+ * All durations are given in teensy_clock durations, e.g. 250ms or 2min
+ ************************************************************************************/
+
+#include "IntervalTimerEx.h"
+#include "teensy_clock.h"
+#include <functional>
+
+class TimerWheel
+{
+ public:
+    using callback_t = std::function<void()>;
+    using duration   = teensy_clock::duration;
+
+    class Timer;
+
+    bool begin(duration tickPeriod);
+    void end();
+
+    void start(Timer& timer, callback_t callback, duration delay);            // one shot
+    void startPeriodic(Timer& timer, callback_t callback, duration period);   // periodic
+    void cancel(Timer& timer);
+
+    void tick();                                                              // advances the wheel by one tick, called from the timer ISR
+    uint32_t ticks() const { return now; }                                    // number of ticks processed since begin()
+    duration tickPeriod() const { return duration(tickCycles); }
+
+    TimerWheel();
+    ~TimerWheel();
+
+ protected:
+    struct Node
+    {
+        Node* prev;
+        Node* next;
+    };
+
+    static constexpr unsigned levelBits = 6;
+    static constexpr unsigned nrOfSlots = 1 << levelBits; // 64 slots per level
+    static constexpr unsigned slotMask  = nrOfSlots - 1;
+    static constexpr unsigned nrOfLevels = 4;
+    static constexpr uint32_t maxDelta   = (1UL << (levelBits * nrOfLevels)) - 1;
+
+    void arm(Timer& timer, callback_t&& callback, duration delay, duration period);
+    void insert(Timer& timer);
+    void cascade(unsigned level);
+    uint32_t toTicks(duration d) const;
+
+    static void unlink(Node* node);
+    static void pushBack(Node* list, Node* node);
+
+    Node slots[nrOfLevels][nrOfSlots];
+    IntervalTimerEx timer;
+    volatile uint32_t now = 0;
+    uint64_t tickCycles   = 0;
+    Timer* volatile running = nullptr; // timer whose callback is currently executed by tick()
+};
+
+class TimerWheel::Timer : protected TimerWheel::Node
+{
+ public:
+    Timer() { prev = next = nullptr; }
+    ~Timer() { if (wheel) wheel->cancel(*this); }
+
+    bool isActive() const { return next != nullptr; }
+
+ protected:
+    TimerWheel* wheel = nullptr;
+    uint32_t expires  = 0; // absolute tick at which the timer fires
+    uint32_t period   = 0; // period in ticks, 0 for one shot timers
+    callback_t callback;
+
+    friend TimerWheel;
+};
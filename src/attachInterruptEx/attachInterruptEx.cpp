@@ -1,7 +1,188 @@
 #include "attachInterruptEx.h"
 #include "core_pins.h"
+#include "cycles64.h"
 #include <array>
 
+// Deferred mode ========================================================================
+
+namespace
+{
+    static_assert((DEFERRED_QUEUE_SIZE & (DEFERRED_QUEUE_SIZE - 1)) == 0, "DEFERRED_QUEUE_SIZE needs to be a power of 2");
+    constexpr uint32_t queueMask = DEFERRED_QUEUE_SIZE - 1;
+
+    std::function<void(const PinEvent&)> deferredCallbacks[CORE_NUM_DIGITAL];
+
+    // single producer (pin interrupts) / single consumer (processDeferredInterrupts) ring buffer
+    PinEvent queue[DEFERRED_QUEUE_SIZE];
+    volatile uint32_t head = 0; // free running, only written by the producer
+    volatile uint32_t tail = 0; // free running, only written by the consumer
+    volatile uint32_t overflows     = 0;
+    volatile uint32_t highWaterMark = 0;
+
+    inline void pushEvent(unsigned pin, uint8_t level)
+    {
+        uint32_t h    = head;
+        uint32_t used = h - tail;
+        if (used >= DEFERRED_QUEUE_SIZE)
+        {
+            overflows = overflows + 1;
+            return;
+        }
+
+        PinEvent& ev = queue[h & queueMask];
+        ev.timestamp = cycles64::get();
+        ev.pin       = pin;
+        ev.level     = level;
+
+        if (++used > highWaterMark) highWaterMark = used;
+
+        asm volatile("" ::: "memory"); // event needs to be complete before it is published
+        head = h + 1;
+    }
+} // namespace
+
+unsigned processDeferredInterrupts(unsigned maxEvents)
+{
+    unsigned n = 0;
+    while (n < maxEvents && tail != head)
+    {
+        uint32_t t  = tail;
+        PinEvent ev = queue[t & queueMask];
+        asm volatile("" ::: "memory"); // copy the event before releasing its slot
+        tail = t + 1;
+
+        if (deferredCallbacks[ev.pin]) deferredCallbacks[ev.pin](ev);
+        n++;
+    }
+    return n;
+}
+
+DeferredStats getDeferredStats()
+{
+    return DeferredStats{overflows, highWaterMark, DEFERRED_QUEUE_SIZE};
+}
+
+void resetDeferredStats()
+{
+    overflows     = 0;
+    highWaterMark = 0;
+}
+
+// Immediate mode =======================================================================
+
+#if defined(USE_PORT_DISPATCHER) && defined(__IMXRT1062__)
+
+namespace
+{
+    constexpr unsigned num_ports = 4; // fast GPIO6 ... GPIO9
+
+    constexpr unsigned IMR_INDEX = 5; // register offsets relative to GPIOn_DR
+    constexpr unsigned ISR_INDEX = 6;
+
+    volatile uint32_t* const ports[num_ports]{&GPIO6_DR, &GPIO7_DR, &GPIO8_DR, &GPIO9_DR};
+
+    // dense per port tables, indexed by the bit number of the pin
+    std::function<void()> callbacks[num_ports][32];
+    volatile uint32_t owned[num_ports]; // pins with a callback in the tables above
+
+    void (*coreIsr)() = nullptr; // handler which was installed before the dispatcher, serves pins attached by the core attachInterrupt
+
+    inline unsigned portOf(unsigned pin) { return ((uintptr_t)digital_pin_to_info_PGM[pin].reg - (uintptr_t)&GPIO6_DR) >> 14; } // GPIO6..9 are 0x4000 apart
+    inline unsigned bitOf(unsigned pin) { return __builtin_ctz(digital_pin_to_info_PGM[pin].mask); }
+
+    // replaces the core isr. Reads the status of each port only once, clears all pending
+    // bits of our pins with a single write and walks the set bits using count trailing zeros.
+    // Pending bits of other pins are left to the core handler
+    void dispatcher()
+    {
+        bool foreign = false;
+        for (unsigned port = 0; port < num_ports; port++)
+        {
+            volatile uint32_t* gpio = ports[port];
+            uint32_t pending        = gpio[ISR_INDEX] & gpio[IMR_INDEX];
+            uint32_t status         = pending & owned[port];
+            if (pending != status)
+            {
+                if (coreIsr)
+                    foreign = true;
+                else
+                    gpio[ISR_INDEX] = pending & ~status; // nobody serves them, clear to avoid an interrupt storm
+            }
+            if (status == 0) continue;
+
+            gpio[ISR_INDEX] = status; // write 1 to clear
+
+            std::function<void()>* table = callbacks[port];
+            do
+            {
+                table[__builtin_ctz(status)]();
+                status &= status - 1; // clear lowest set bit
+            } while (status);
+        }
+        if (foreign) coreIsr(); // only sees the bits of the foreign pins, ours are cleared already
+#if defined(__arm__)
+        asm volatile("dsb" ::: "memory"); // prevent double calls of the isr
+#endif
+    }
+
+    // core compatible pin isrs. They are attached instead of a dummy, so our pins keep
+    // working if a later core attachInterrupt() reinstalls the core handler
+    template <unsigned pin>
+    void pinRelay()
+    {
+        auto& callback = callbacks[portOf(pin)][bitOf(pin)];
+        if (callback) callback();
+    }
+
+    template <std::size_t... I>
+    constexpr std::array<void (*)(), CORE_NUM_DIGITAL> MakePinRelays(std::index_sequence<I...>)
+    {
+        return std::array<void (*)(), CORE_NUM_DIGITAL>{pinRelay<I>...};
+    }
+
+    constexpr auto pinRelays = MakePinRelays(std::make_index_sequence<CORE_NUM_DIGITAL>{});
+} // namespace
+
+void attachInterruptEx(unsigned pin, std::function<void(void)> callback, int mode)
+{
+    if (pin >= CORE_NUM_DIGITAL) return;
+
+    unsigned port = portOf(pin);
+    unsigned bit  = bitOf(pin);
+
+    noInterrupts();
+    callbacks[port][bit] = callback;
+    if (callbacks[port][bit])
+        owned[port] = owned[port] | (1UL << bit);
+    else
+        owned[port] = owned[port] & ~(1UL << bit);
+    interrupts();
+
+    if (!callbacks[port][bit]) // same as the relay mode: a null callback detaches the pin
+    {
+        detachInterrupt(pin);
+        return;
+    }
+
+    attachInterrupt(pin, pinRelays[pin], mode); // let the core do the pin and edge configuration...
+
+    noInterrupts();                             // ...but take over the shared GPIO interrupt
+    void (*current)() = _VectorsRam[IRQ_GPIO6789 + 16];
+    if (current != dispatcher) coreIsr = current;
+    attachInterruptVector(IRQ_GPIO6789, dispatcher);
+    interrupts();
+}
+
+void attachDeferredInterruptEx(unsigned pin, std::function<void(const PinEvent&)> callback, int mode)
+{
+    if (pin >= CORE_NUM_DIGITAL) return;
+
+    deferredCallbacks[pin] = callback;
+    attachInterruptEx(pin, [pin] { pushEvent(pin, digitalRead(pin)); }, mode);
+}
+
+#else
+
 namespace
 {
     constexpr unsigned num_pins = CORE_NUM_DIGITAL;
@@ -25,10 +206,177 @@ namespace
 
     // the actual array of relay functions. Generated at compile time.
     constexpr auto relays = MakeRelays(std::make_index_sequence<num_pins>{});
+
+    // relay functions for the deferred mode, they only queue the event
+    template <unsigned nr>
+    void deferredRelay()
+    {
+        pushEvent(nr, digitalReadFast(nr));
+    }
+
+    template <std::size_t... I>
+    constexpr std::array<void (*)(), num_pins> MakeDeferredRelays(std::index_sequence<I...>)
+    {
+        return std::array<void (*)(), num_pins>{deferredRelay<I>...};
+    }
+
+    constexpr auto deferredRelays = MakeDeferredRelays(std::make_index_sequence<num_pins>{});
 } // namespace
 
 void attachInterruptEx(unsigned pin, std::function<void(void)> callback, int mode)
 {
+    if (pin >= CORE_NUM_DIGITAL) return;
+
     callbacks[pin] = callback;               // store the callback function in its array
+    if (!callbacks[pin])                     // relays don't check for empty callbacks
+    {
+        detachInterrupt(pin);
+        return;
+    }
     attachInterrupt(pin, relays[pin], mode); // attach the relay function to the pin interrupt
-}
\ No newline at end of file
+}
+
+void attachDeferredInterruptEx(unsigned pin, std::function<void(const PinEvent&)> callback, int mode)
+{
+    if (pin >= CORE_NUM_DIGITAL) return;
+
+    deferredCallbacks[pin] = callback;
+    attachInterrupt(pin, deferredRelays[pin], mode);
+}
+
+#endif
+
+// Counting mode ========================================================================
+
+namespace
+{
+    struct Counter
+    {
+        volatile uint32_t seq;   // incremented by each update, readers retry if it changed during the copy
+        volatile int32_t count;
+        volatile uint32_t period;
+        volatile uint64_t last;
+        uint8_t quadState;       // last A/B level of a quadrature counter
+    };
+
+    struct Quadrature
+    {
+        volatile uint32_t* inA;
+        volatile uint32_t* inB;
+        uint32_t maskA, maskB;
+        uint8_t counter;         // the counter is stored under pinA for both pins
+    };
+
+    Counter counters[CORE_NUM_DIGITAL];
+    Quadrature quadratures[CORE_NUM_DIGITAL];
+
+    // position change for (old state << 2 | new state), state = A << 1 | B. A leading B counts up
+    constexpr int8_t quadSteps[16] = {0, -1, +1, 0, +1, 0, 0, -1, -1, 0, 0, +1, 0, +1, -1, 0};
+
+    inline void countEdge(Counter& c, int32_t step)
+    {
+        uint64_t now   = cycles64::get();
+        uint64_t delta = c.last != 0 ? now - c.last : 0;
+        c.period       = delta < UINT32_MAX ? (uint32_t)delta : UINT32_MAX; // saturates after ~7.2s @600MHz
+        c.last       = now;
+        c.count      = c.count + step;
+        c.seq        = c.seq + 1;
+    }
+
+    template <unsigned nr>
+    void countRelay()
+    {
+        countEdge(counters[nr], 1);
+    }
+
+    template <unsigned nr>
+    void quadratureRelay()
+    {
+        const Quadrature& q = quadratures[nr];
+        Counter& c          = counters[q.counter];
+
+        uint8_t state = ((*q.inA & q.maskA) ? 2 : 0) | ((*q.inB & q.maskB) ? 1 : 0);
+        int8_t step   = quadSteps[(c.quadState << 2) | state];
+        c.quadState   = state;
+        if (step != 0) countEdge(c, step); // no change or invalid transition (missed edge)
+    }
+
+    template <std::size_t... I>
+    constexpr std::array<void (*)(), CORE_NUM_DIGITAL> MakeCountRelays(std::index_sequence<I...>)
+    {
+        return std::array<void (*)(), CORE_NUM_DIGITAL>{countRelay<I>...};
+    }
+
+    template <std::size_t... I>
+    constexpr std::array<void (*)(), CORE_NUM_DIGITAL> MakeQuadratureRelays(std::index_sequence<I...>)
+    {
+        return std::array<void (*)(), CORE_NUM_DIGITAL>{quadratureRelay<I>...};
+    }
+
+    constexpr auto countRelays      = MakeCountRelays(std::make_index_sequence<CORE_NUM_DIGITAL>{});
+    constexpr auto quadratureRelays = MakeQuadratureRelays(std::make_index_sequence<CORE_NUM_DIGITAL>{});
+
+    void attachRelay(unsigned pin, void (*relay)(), int mode)
+    {
+#if defined(USE_PORT_DISPATCHER) && defined(__IMXRT1062__)
+        attachInterruptEx(pin, relay, mode); // plain function pointer in the dispatcher table, no captures
+#else
+        attachInterrupt(pin, relay, mode);
+#endif
+    }
+} // namespace
+
+void attachCounterInterruptEx(unsigned pin, int mode)
+{
+    if (pin >= CORE_NUM_DIGITAL) return;
+
+    resetPulseCounter(pin);
+    attachRelay(pin, countRelays[pin], mode);
+}
+
+void attachQuadratureInterruptEx(unsigned pinA, unsigned pinB)
+{
+    if (pinA >= CORE_NUM_DIGITAL || pinB >= CORE_NUM_DIGITAL || pinA == pinB) return;
+
+    Quadrature q{portInputRegister(pinA), portInputRegister(pinB), digitalPinToBitMask(pinA), digitalPinToBitMask(pinB), (uint8_t)pinA};
+    quadratures[pinA] = q;
+    quadratures[pinB] = q;
+
+    resetPulseCounter(pinA);
+    counters[pinA].quadState = (digitalReadFast(pinA) ? 2 : 0) | (digitalReadFast(pinB) ? 1 : 0);
+
+    attachRelay(pinA, quadratureRelays[pinA], CHANGE);
+    attachRelay(pinB, quadratureRelays[pinB], CHANGE);
+}
+
+PulseSnapshot getPulseSnapshot(unsigned pin)
+{
+    PulseSnapshot snapshot{0, 0, 0, 0.0f};
+    if (pin >= CORE_NUM_DIGITAL) return snapshot;
+
+    const Counter& c = counters[pin];
+    uint32_t seq;
+    do // the ISR can't be interrupted by the reader, retry if it ran during the copy
+    {
+        seq               = c.seq;
+        snapshot.count    = c.count;
+        snapshot.lastEdge = c.last;
+        snapshot.period   = c.period;
+    } while (seq != c.seq);
+
+    snapshot.frequency = snapshot.period != 0 ? (float)F_CPU / snapshot.period : 0.0f;
+    return snapshot;
+}
+
+void resetPulseCounter(unsigned pin)
+{
+    if (pin >= CORE_NUM_DIGITAL) return;
+
+    noInterrupts();
+    Counter& c = counters[pin];
+    c.count    = 0;
+    c.period   = 0;
+    c.last     = 0;
+    c.seq      = c.seq + 1;
+    interrupts();
+}
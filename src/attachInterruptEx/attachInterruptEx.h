@@ -1,5 +1,60 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 
+//#define USE_PORT_DISPATCHER             // uncomment to dispatch all pin interrupts of a GPIO port in one go (T4.x only)
+
+#define DEFERRED_QUEUE_SIZE 64            // number of pin events the deferred queue can hold, needs to be a power of 2
+
 extern void attachInterruptEx(unsigned pin, std::function<void(void)> callback, int mode);
+
+// Deferred mode ----------------------------------------------------------------------
+// The interrupt only stores the pin, a cycles64 timestamp and the pin level in a queue.
+// The callbacks are called later from processDeferredInterrupts() (e.g. from loop or yield).
+// Timestamps require a running cycles64 (cycles64::begin() or teensy_clock::begin())
+//
+// The queue is lock free with a single producer and a single consumer: the pin interrupts
+// must not preempt each other, i.e. all GPIO interrupts need to run at the same priority.
+// (T4.x: all pins share IRQ_GPIO6789. T3.x: don't change the priority of single IRQ_PORTx)
+// processDeferredInterrupts() must only be called from one context (e.g. loop or yield).
+
+struct PinEvent
+{
+    uint64_t timestamp; // cycles64::get() at interrupt time
+    uint8_t pin;
+    uint8_t level;      // pin level at interrupt time
+};
+
+struct DeferredStats
+{
+    uint32_t overflows;     // number of events dropped because the queue was full
+    uint32_t highWaterMark; // maximum number of queued events seen so far
+    uint32_t capacity;      // DEFERRED_QUEUE_SIZE
+};
+
+extern void attachDeferredInterruptEx(unsigned pin, std::function<void(const PinEvent&)> callback, int mode);
+extern unsigned processDeferredInterrupts(unsigned maxEvents = UINT32_MAX); // calls the callbacks of queued events, returns the number of processed events
+extern DeferredStats getDeferredStats();
+extern void resetDeferredStats();
+
+// Counting mode ----------------------------------------------------------------------
+// No callbacks. Compile time generated ISRs update the edge counter, the cycles64
+// timestamp of the last edge and the period in place. Quadrature mode decodes all 4
+// edges of an A/B encoder, the count is the position. getPulseSnapshot() reads a
+// consistent copy without disabling interrupts. Use detachInterrupt() to stop counting.
+// Timestamps require a running cycles64 (cycles64::begin() or teensy_clock::begin())
+
+struct PulseSnapshot
+{
+    int32_t count;     // number of edges, quadrature mode: position
+    uint64_t lastEdge; // cycles64 timestamp of the last edge
+    uint32_t period;   // cycles between the last two edges (0: less than 2 edges, UINT32_MAX: 2^32 cycles or more)
+    float frequency;   // edges per second calculated from period
+};
+
+extern void attachCounterInterruptEx(unsigned pin, int mode);          // counts the edges (RISING, FALLING, CHANGE) on pin
+extern void attachQuadratureInterruptEx(unsigned pinA, unsigned pinB); // quadrature decoder, the counter is stored under pinA
+extern PulseSnapshot getPulseSnapshot(unsigned pin);
+extern void resetPulseCounter(unsigned pin);
+
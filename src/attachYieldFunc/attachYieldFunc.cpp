@@ -1,15 +1,182 @@
 #include "attachYieldFunc.h"
+#include "Arduino.h"
 #include "EventResponder.h"
+#include "criticalSection.h"
 
-void attachYieldFunc(yieldFunc_t _yieldFunc) // pass a pointer to the function you want to be called from yield
+namespace YieldScheduler
 {
-  static yieldFunc_t yieldFunc = _yieldFunc; // store the passed in function pointer
-  static EventResponder er;                  // define a new EventResponder which will handle the calls.
+    namespace // private -----------------------------
+    {
+        struct Task
+        {
+            yieldFunc_t func;
+            int id;
+            int priority;
+            uint32_t interval; // cycles
+            uint32_t budget;   // cycles
+            uint32_t lastStart;
+            TaskStats stats;
+        };
+
+        Task tasks[MAX_YIELD_TASKS]; // sorted by descending priority
+        unsigned nrOfTasks = 0;
+        int nextId         = 1;
+        bool running       = false;
+        bool dirty         = false; // removed tasks need to be compacted
+        uint32_t overhead  = 0;
+
+        EventResponder er;
+
+        // removes the slots of deleted tasks, keeps the priority order
+        void compact()
+        {
+            unsigned j = 0;
+            for (unsigned i = 0; i < nrOfTasks; i++)
+            {
+                if (tasks[i].func != nullptr) tasks[j++] = tasks[i];
+            }
+            nrOfTasks = j;
+            dirty     = false;
+        }
+
+        void run()
+        {
+            uint32_t start      = ARM_DWT_CYCCNT;
+            uint32_t taskCycles = 0;
+
+            running = true;
+            for (unsigned i = 0; i < nrOfTasks; i++)
+            {
+                Task& t     = tasks[i];
+                uint32_t t0 = ARM_DWT_CYCCNT;
+                yieldFunc_t func = t.func; // read once, an interrupt might remove the task
+                if (func == nullptr) continue;
+                if (t.stats.calls != 0 && t0 - t.lastStart < t.interval) continue;
+
+                t.lastStart = t0;
+                func();
+                uint32_t dt = ARM_DWT_CYCCNT - t0;
+
+                TaskStats& s = t.stats;
+                s.calls++;
+                s.lastCycles = dt;
+                s.totalCycles += dt;
+                if (dt > s.maxCycles) s.maxCycles = dt;
+                if (t.budget != 0 && dt > t.budget) s.overruns++;
+                taskCycles += dt;
+            }
+            {
+                CriticalSection cs;
+                running = false;
+                if (dirty) compact();
+            }
+
+            uint32_t ovl = (ARM_DWT_CYCCNT - start) - taskCycles;
+            if (ovl > overhead) overhead = ovl;
+        }
+
+        void begin()
+        {
+            static bool started = false;
+            if (started) return;
+            started = true;
+
+            er.attach([](EventResponderRef r) { // relay which calls the scheduler and retriggers the responder to schedule the next call
+                run();
+                r.triggerEvent();
+            });
+            er.triggerEvent();
+        }
+
+        Task* find(int id)
+        {
+            for (unsigned i = 0; i < nrOfTasks; i++)
+            {
+                if (tasks[i].id == id && tasks[i].func != nullptr) return &tasks[i];
+            }
+            return nullptr;
+        }
+
+    } // end private namespace <<---------------------
 
-  er.attach([](EventResponderRef r) {        // we can not directly attach our function to the responder since we need to retrigger the repsonder
-    yieldFunc();                             // instead we attach an inline defined relay function as lambda expression
-    r.triggerEvent();                        // the relay calls our function and afterwards triggers the responder to schedule the next call.
-  });
+    int addTask(yieldFunc_t func, int priority, uint32_t minInterval_us, uint32_t budget)
+    {
+        uint64_t interval = (uint64_t)minInterval_us * (F_CPU / 1'000'000);
+        if (func == nullptr || interval > UINT32_MAX) return 0; // the interval is compared to the 32bit cycle counter
 
-  er.triggerEvent();                         // to start the call chain we need to trigger the responder once
-}
\ No newline at end of file
+        int id;
+        {
+            CriticalSection cs;    // the list might be changed from an interrupt
+            if (running) return 0; // would reorder the task list under the running scheduler
+            if (dirty) compact();
+            if (nrOfTasks >= MAX_YIELD_TASKS) return 0;
+
+            unsigned pos = nrOfTasks; // insert behind all tasks with the same or higher priority
+            while (pos > 0 && tasks[pos - 1].priority < priority)
+            {
+                tasks[pos] = tasks[pos - 1];
+                pos--;
+            }
+
+            Task& t    = tasks[pos];
+            t.func     = func;
+            t.id       = nextId++;
+            t.priority = priority;
+            t.interval = (uint32_t)interval;
+            t.budget   = budget;
+            t.stats    = TaskStats{};
+            nrOfTasks++;
+            id = t.id;
+        }
+
+        begin();
+        return id;
+    }
+
+    bool removeTask(int id)
+    {
+        CriticalSection cs;
+        Task* t = find(id);
+        if (t == nullptr) return false;
+
+        t->func = nullptr;
+        dirty   = true;
+        if (!running) compact(); // when called from a task, compaction is done after the current run
+        return true;
+    }
+
+    bool getStats(int id, TaskStats& stats)
+    {
+        CriticalSection cs;
+        Task* t = find(id);
+        if (t == nullptr) return false;
+
+        stats = t->stats;
+        return true;
+    }
+
+    uint32_t maxOverhead()
+    {
+        return overhead;
+    }
+
+    void printStats(Stream& stream)
+    {
+        stream.printf("  id  prio       calls    last     max       mean  overruns\n");
+        for (unsigned i = 0; i < nrOfTasks; i++)
+        {
+            const Task& t = tasks[i];
+            if (t.func == nullptr) continue;
+
+            const TaskStats& s = t.stats;
+            uint32_t mean      = s.calls ? (uint32_t)(s.totalCycles / s.calls) : 0;
+            stream.printf("%4d %5d %11lu %7lu %7lu %10lu %9lu\n", t.id, t.priority, s.calls, s.lastCycles, s.maxCycles, mean, s.overruns);
+        }
+        stream.printf("max scheduler overhead: %lu cycles\n", overhead);
+    }
+}
+
+void attachYieldFunc(yieldFunc_t _yieldFunc) // pass a pointer to the function you want to be called from yield
+{
+    YieldScheduler::addTask(_yieldFunc);
+}
@@ -1,5 +1,38 @@
 #pragma once
 
+#include <cstdint>
+
+class Stream;
+
 using yieldFunc_t = void(*)();
 
-extern void attachYieldFunc(yieldFunc_t yieldFunction);
\ No newline at end of file
+#define MAX_YIELD_TASKS 16                   // maximum number of functions which can be attached to yield
+
+extern void attachYieldFunc(yieldFunc_t yieldFunction);  // attaches a function with default settings, same as YieldScheduler::addTask(yieldFunction)
+
+namespace YieldScheduler
+{
+    struct TaskStats
+    {
+        uint32_t calls;         // number of calls
+        uint32_t lastCycles;    // duration of the last call
+        uint32_t maxCycles;     // longest call
+        uint64_t totalCycles;   // sum of all calls
+        uint32_t overruns;      // number of calls exceeding the cycle budget
+    };
+
+    // Adds a task to the yield scheduler. Tasks with higher priority are called first.
+    // minInterval_us: the task is not called more often than this (0: call on every yield)
+    //                 max UINT32_MAX cycles, i.e. ~7.1s at 600MHz
+    // budget:         expected maximum cycles per call, longer calls are counted as overruns (0: no budget)
+    //                 Diagnostic only, a task which overruns its budget is still called as usual
+    // Returns a task id (>0) or 0 if all slots are used, the interval is too long or
+    // when called while the scheduler runs (from a task or from an interrupt during a yield call).
+    // addTask and removeTask change the task list with interrupts disabled, both can be used from interrupts.
+    extern int addTask(yieldFunc_t func, int priority = 0, uint32_t minInterval_us = 0, uint32_t budget = 0);
+    extern bool removeTask(int id);          // can be called at any time, even from a running task or an interrupt
+
+    extern bool getStats(int id, TaskStats& stats);
+    extern uint32_t maxOverhead();           // worst case scheduling overhead per yield call in cycles
+    extern void printStats(Stream& stream);
+}
@@ -0,0 +1,251 @@
+#include "coTask.h"
+#include "attachInterruptEx.h"
+#include "attachYieldFunc.h"
+
+namespace CoTask
+{
+    namespace // private -----------------------------
+    {
+        // frame pool, free frames are chained through their first word
+        alignas(8) uint8_t frames[MAX_COROUTINES][COROUTINE_FRAME_SIZE];
+        void* freeFrames = nullptr;
+        unsigned usedFrames = 0;
+        bool poolInitialized = false;
+
+        // ready coroutines (started or waiting for the next yield), ring buffer
+        std::coroutine_handle<> ready[MAX_COROUTINES];
+        unsigned readyHead = 0, readyCount = 0;
+
+        // sleeping coroutines, binary min heap ordered by deadline
+        struct Sleeper
+        {
+            teensy_clock::time_point deadline;
+            std::coroutine_handle<> handle;
+        };
+        Sleeper sleepers[MAX_COROUTINES];
+        unsigned nrOfSleepers = 0;
+
+        // coroutines waiting for pin edges, fired is set from the pin interrupt
+        struct PinWaiter
+        {
+            std::coroutine_handle<> handle;
+            uint8_t pin;
+            int mode;
+            volatile bool fired;
+        };
+        PinWaiter pinWaiters[MAX_COROUTINES];
+
+        Stats stats{};
+        bool running = false;
+
+        void initPool()
+        {
+            for (auto& frame : frames)
+            {
+                *(void**)frame = freeFrames;
+                freeFrames     = frame;
+            }
+            poolInitialized = true;
+        }
+
+        void pushReady(std::coroutine_handle<> h)
+        {
+            ready[(readyHead + readyCount++) % MAX_COROUTINES] = h;
+        }
+
+        std::coroutine_handle<> popReady()
+        {
+            std::coroutine_handle<> h = ready[readyHead];
+            readyHead                 = (readyHead + 1) % MAX_COROUTINES;
+            readyCount--;
+            return h;
+        }
+
+        void pushSleeper(const Sleeper& s)
+        {
+            unsigned i = nrOfSleepers++;
+            while (i > 0) // sift up
+            {
+                unsigned parent = (i - 1) / 2;
+                if (sleepers[parent].deadline <= s.deadline) break;
+                sleepers[i] = sleepers[parent];
+                i           = parent;
+            }
+            sleepers[i] = s;
+        }
+
+        Sleeper popSleeper()
+        {
+            Sleeper top  = sleepers[0];
+            Sleeper last = sleepers[--nrOfSleepers];
+            unsigned i   = 0;
+            while (true) // sift down
+            {
+                unsigned child = 2 * i + 1;
+                if (child >= nrOfSleepers) break;
+                if (child + 1 < nrOfSleepers && sleepers[child + 1].deadline < sleepers[child].deadline) child++;
+                if (last.deadline <= sleepers[child].deadline) break;
+                sleepers[i] = sleepers[child];
+                i           = child;
+            }
+            sleepers[i] = last;
+            return top;
+        }
+
+        const PinWaiter* waiterFor(uint8_t pin)
+        {
+            for (const PinWaiter& w : pinWaiters)
+            {
+                if (w.handle && w.pin == pin) return &w;
+            }
+            return nullptr;
+        }
+
+        bool waitsForPin(uint8_t pin)
+        {
+            return waiterFor(pin) != nullptr;
+        }
+
+        bool interruptAttached(uint8_t pin) // GPIOn_IMR bit, set by attachInterrupt, cleared by detachInterrupt
+        {
+            constexpr unsigned IMR_INDEX = 5; // register offset relative to GPIOn_DR
+            return portOutputRegister(pin)[IMR_INDEX] & digitalPinToBitMask(pin);
+        }
+
+        void resume(std::coroutine_handle<> h)
+        {
+            stats.resumes++;
+            h.resume();
+        }
+    } // end private namespace <<---------------------
+
+    void* Task::promise_type::operator new(size_t size) noexcept
+    {
+        if (!poolInitialized) initPool();
+
+        if (size > COROUTINE_FRAME_SIZE || freeFrames == nullptr)
+        {
+            stats.allocationFailures++;
+            return nullptr;
+        }
+        void* frame = freeFrames;
+        freeFrames  = *(void**)frame;
+
+        if (++usedFrames > stats.maxActive) stats.maxActive = usedFrames;
+        return frame;
+    }
+
+    void Task::promise_type::operator delete(void* frame) noexcept
+    {
+        *(void**)frame = freeFrames;
+        freeFrames     = frame;
+        usedFrames--;
+    }
+
+    bool start(Task&& task)
+    {
+        if (!task) return false;
+        pushReady(task.handle);
+        task.handle = nullptr; // owned by the executor from now on
+        return true;
+    }
+
+    void run()
+    {
+        if (running) return; // prevent recursion if a coroutine calls yield (e.g. delay())
+        running = true;
+
+        // coroutines which become ready during this call are resumed on the next call
+        for (unsigned n = readyCount; n > 0; n--)
+        {
+            resume(popReady());
+        }
+
+        if (nrOfSleepers > 0)
+        {
+            teensy_clock::time_point now = teensy_clock::now();
+            while (nrOfSleepers > 0 && sleepers[0].deadline <= now)
+            {
+                Sleeper s    = popSleeper();
+                uint32_t late = teensy_clock::toMicros(now - s.deadline);
+                if (late > stats.maxLateness_us) stats.maxLateness_us = late;
+                resume(s.handle);
+            }
+        }
+
+        for (PinWaiter& w : pinWaiters)
+        {
+            if (w.handle && w.fired)
+            {
+                std::coroutine_handle<> h = w.handle;
+                w.handle                  = nullptr;
+                if (!waitsForPin(w.pin)) detachInterrupt(w.pin);
+                resume(h);
+            }
+        }
+
+        running = false;
+    }
+
+    bool begin()
+    {
+        static bool started = false;
+        if (started) return true;
+
+        cycles64::begin();
+        started = YieldScheduler::addTask(run) != 0;
+        return started;
+    }
+
+    Stats getStats()
+    {
+        Stats s  = stats;
+        s.active = usedFrames;
+        return s;
+    }
+
+    //-------------------------------------------------------------------------------
+    // awaitables
+
+    void SleepAwaiter::await_suspend(std::coroutine_handle<> h)
+    {
+        pushSleeper({deadline, h});
+    }
+
+    bool PinAwaiter::await_suspend(std::coroutine_handle<> h)
+    {
+        const PinWaiter* other = waiterFor(pin);
+        bool refused           = other ? other->mode != mode       // the pin is already configured for another edge
+                                       : interruptAttached(pin);  // the pin interrupt belongs to someone else
+        if (!refused)
+        {
+            for (PinWaiter& w : pinWaiters)
+            {
+                if (w.handle) continue;
+
+                w.fired  = false;
+                w.pin    = pin;
+                w.mode   = mode;
+                w.handle = h;
+                waited   = true;
+
+                if (other) return true; // already attached
+                uint8_t p = pin;
+                attachInterruptEx(p, [p] { // wakes all coroutines waiting for this pin
+                    for (PinWaiter& waiter : pinWaiters)
+                    {
+                        if (waiter.handle && waiter.pin == p) waiter.fired = true;
+                    }
+                }, mode);
+                return true;
+            }
+        }
+        stats.pinWaitFailures++;
+        return false;
+    }
+
+    void YieldAwaiter::await_suspend(std::coroutine_handle<> h)
+    {
+        pushReady(h);
+    }
+}
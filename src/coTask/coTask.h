@@ -0,0 +1,130 @@
+#pragma once
+/************************************************************************************
+ * Small C++20 coroutine executor driven from yield()
+ *
+ *   CoTask::Task blink()
+ *   {
+ *       while (true)
+ *       {
+ *           digitalToggleFast(LED_BUILTIN);
+ *           co_await CoTask::sleep_for(250ms);
+ *       }
+ *   }
+ *
+ *   CoTask::begin();          // resume the coroutines from yield()
+ *   CoTask::start(blink());
+ *
+ * Coroutine frames are taken from a fixed pool (MAX_COROUTINES frames of
+ * COROUTINE_FRAME_SIZE bytes), not from the heap. If the frame of a coroutine doesn't
+ * fit or the pool is exhausted, start() returns false. Sleeping coroutines are kept in
+ * a heap ordered by their teensy_clock deadline, i.e. run() only checks the earliest one.
+ *
+ * start(task):            hands the coroutine over to the executor
+ * run():                  resumes all ready coroutines (called from yield after begin())
+ * begin():                attaches run() to yield, false if the yield scheduler has no free slot
+ * co_await sleep_for(d):  suspends for the teensy_clock::duration d
+ * co_await sleep_until(t) suspends until the teensy_clock::time_point t
+ * co_await pin_edge(pin): suspends until the next edge (mode: RISING, FALLING, CHANGE) on pin.
+ *                         Returns false without waiting if all MAX_COROUTINES pin slots are used,
+ *                         if other coroutines wait for a different edge on the same pin or if
+ *                         the pin has an interrupt attached by someone else (attachInterrupt(Ex))
+ * co_await next_yield():  suspends until the next call of run()
+ *
+ * Needs C++20 (-std=gnu++20), teensy_clock, attachInterruptEx and attachYieldFunc
+ ************************************************************************************/
+
+#if !defined(__cpp_impl_coroutine)
+    #error "CoTask needs C++20 coroutines (-std=gnu++20)"
+#endif
+
+#include "teensy_clock.h"
+#include <coroutine>
+#include <exception>
+
+#define MAX_COROUTINES 16        // maximum number of coroutines alive at the same time
+#define COROUTINE_FRAME_SIZE 256 // bytes per coroutine frame (locals which live across co_await + ~40 bytes)
+
+namespace CoTask
+{
+    class Task
+    {
+     public:
+        struct promise_type
+        {
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            static Task get_return_object_on_allocation_failure() { return Task(nullptr); }
+
+            std::suspend_always initial_suspend() noexcept { return {}; } // started by the executor
+            std::suspend_never final_suspend() noexcept { return {}; }    // frame is released when the coroutine ends
+
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); } // nobody awaits a task, don't swallow the exception
+
+            static void* operator new(size_t size) noexcept; // frames come from the pool
+            static void operator delete(void* frame) noexcept;
+        };
+
+        Task(Task&& other) : handle(other.handle) { other.handle = nullptr; }
+        ~Task()
+        {
+            if (handle) handle.destroy(); // never started
+        }
+
+        explicit operator bool() const { return (bool)handle; }
+
+     private:
+        explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+        std::coroutine_handle<promise_type> handle;
+
+        friend bool start(Task&& task);
+    };
+
+    struct Stats
+    {
+        unsigned active;             // number of living coroutines
+        unsigned maxActive;          // high water mark
+        uint32_t allocationFailures; // coroutines which didn't fit into the pool
+        uint32_t resumes;            // number of resumed coroutines
+        uint32_t maxLateness_us;     // longest delay between a deadline and the resume
+        uint32_t pinWaitFailures;    // pin_edge awaits which were refused (no free slot, other edge mode, foreign interrupt)
+    };
+
+    extern bool start(Task&& task); // returns false if the frame couldn't be allocated
+    extern void run();
+    extern bool begin();            // attaches run() to yield, false if the yield scheduler is full
+    extern Stats getStats();
+
+    // awaitables ---------------------------------------------------------------------
+
+    struct SleepAwaiter
+    {
+        teensy_clock::time_point deadline;
+
+        bool await_ready() const { return teensy_clock::now() >= deadline; }
+        void await_suspend(std::coroutine_handle<> h);
+        void await_resume() const {}
+    };
+
+    struct PinAwaiter
+    {
+        uint8_t pin;
+        int mode;
+        bool waited = false;
+
+        bool await_ready() const { return false; }
+        bool await_suspend(std::coroutine_handle<> h); // false: no free slot, continues immediately
+        bool await_resume() const { return waited; }   // false: no edge, the wait failed
+    };
+
+    struct YieldAwaiter
+    {
+        bool await_ready() const { return false; }
+        void await_suspend(std::coroutine_handle<> h);
+        void await_resume() const {}
+    };
+
+    inline SleepAwaiter sleep_until(teensy_clock::time_point t) { return SleepAwaiter{t}; }
+    inline SleepAwaiter sleep_for(teensy_clock::duration d) { return SleepAwaiter{teensy_clock::now() + d}; }
+    inline PinAwaiter pin_edge(uint8_t pin, int mode = CHANGE) { return PinAwaiter{pin, mode}; }
+    inline YieldAwaiter next_yield() { return YieldAwaiter{}; }
+}
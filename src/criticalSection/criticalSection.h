@@ -0,0 +1,47 @@
+#pragma once
+/************************************************************************************
+ * CriticalSection disables interrupts for its lifetime and restores the previous
+ * state (PRIMASK) at the end of the scope, i.e. it nests and can be used in ISRs.
+ *
+ *   {
+ *       CriticalSection cs;
+ *       ...                 // interrupts disabled
+ *   }                       // previous state restored
+ *
+ * On other targets it falls back to noInterrupts() / interrupts(). The host simulation
+ * restores the previous state, other targets always enable interrupts at the end.
+ ************************************************************************************/
+
+#include "Arduino.h"
+
+class CriticalSection
+{
+ public:
+#if defined(__arm__)
+    CriticalSection()
+    {
+        asm volatile("mrs %0, primask" : "=r"(primask)::"memory");
+        asm volatile("cpsid i" ::: "memory");
+    }
+    ~CriticalSection() { asm volatile("msr primask, %0" ::"r"(primask) : "memory"); }
+
+ protected:
+    uint32_t primask;
+#elif defined(ARDUINO_TEENSY_SIM)
+    CriticalSection() : enabled(sim::irqEnabled()) { noInterrupts(); }
+    ~CriticalSection()
+    {
+        if (enabled) interrupts();
+    }
+
+ protected:
+    bool enabled;
+#else
+    CriticalSection() { noInterrupts(); }
+    ~CriticalSection() { interrupts(); }
+#endif
+
+ public:
+    CriticalSection(const CriticalSection&)            = delete;
+    CriticalSection& operator=(const CriticalSection&) = delete;
+};
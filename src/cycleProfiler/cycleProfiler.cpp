@@ -0,0 +1,106 @@
+#include "cycleProfiler.h"
+#include "criticalSection.h"
+
+namespace CycleProfiler
+{
+    namespace // private
+    {
+        Stream* stream      = &Serial;
+        Site* first         = nullptr;
+        uint32_t probeCycles = 0;
+
+        Site calibrationSite("calibration");
+
+        unsigned bucket(uint32_t cycles)
+        {
+            return 31 - __builtin_clz(cycles | 1);
+        }
+    }
+
+    void Site::record(uint32_t cycles)
+    {
+        if (!registered) // first hit, an interrupt might register another site (or this one) at the same time
+        {
+            CriticalSection cs;
+            if (!registered)
+            {
+                next       = first;
+                first      = this;
+                registered = true;
+            }
+        }
+
+        cycles = cycles > probeCycles ? cycles - probeCycles : 0;
+
+        count++;
+        sum += cycles;
+        if (cycles < min) min = cycles;
+        if (cycles > max) max = cycles;
+        histogram[bucket(cycles)]++;
+    }
+
+    void Site::reset()
+    {
+        count = 0;
+        min   = UINT32_MAX;
+        max   = 0;
+        sum   = 0;
+        for (uint32_t& h : histogram) h = 0;
+    }
+
+    void begin(Stream& _stream)
+    {
+        stream = &_stream;
+
+        // measure an empty probe, the minimum is the overhead of the probe itself
+        calibrationSite.registered = true; // pretend, the calibration site shouldn't show up in the report
+        calibrationSite.reset();
+        probeCycles = 0;
+        for (int i = 0; i < 100; i++)
+        {
+            Scope s(calibrationSite);
+        }
+        probeCycles = calibrationSite.min;
+    }
+
+    Site* sites()
+    {
+        return first;
+    }
+
+    uint32_t overhead()
+    {
+        return probeCycles;
+    }
+
+    void reset()
+    {
+        for (Site* s = first; s != nullptr; s = s->next)
+        {
+            s->reset();
+        }
+    }
+
+    void report()
+    {
+        stream->printf("Probe overhead: %lu cycles (subtracted)\n", probeCycles);
+        stream->printf("%-24s %10s %10s %10s %10s\n", "site", "count", "min", "mean", "max");
+
+        for (Site* s = first; s != nullptr; s = s->next)
+        {
+            if (s->count == 0)
+            {
+                stream->printf("%-24s %10d\n", s->name, 0);
+                continue;
+            }
+            stream->printf("%-24s %10lu %10lu %10lu %10lu\n", s->name, s->count, s->min, (uint32_t)(s->sum / s->count), s->max);
+
+            for (unsigned i = 0; i < nrOfBuckets; i++)
+            {
+                if (s->histogram[i] == 0) continue;
+                stream->printf("    %10lu - %10lu: %lu\n", i == 0 ? 0UL : 1UL << i, (2UL << i) - 1, s->histogram[i]);
+            }
+        }
+        stream->println();
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+/************************************************************************************
+ * Lightweight profiling probes based on the cycle counter (ARM_DWT_CYCCNT).
+ *
+ * Each instrumented site records count, min, max, mean and a log2 histogram of the
+ * measured cycles. Sites are statically allocated (constant initialized, no heap, no
+ * guard variables) and register themselves on their first hit (with interrupts disabled,
+ * sites can be hit first from interrupts). The overhead of a probe is measured by begin()
+ * and subtracted from all measurements recorded after that. Measurements recorded before
+ * begin() include the probe overhead.
+ *
+ * PROFILE_SCOPE("name"):   measures from here to the end of the enclosing scope
+ * PROFILE_BEGIN(id, "name") / PROFILE_END(id): measures a section within a scope
+ *
+ * CycleProfiler::begin(stream): calibrates the probe overhead and sets the output stream
+ * CycleProfiler::report():      prints all sites to the stream
+ * CycleProfiler::reset():       clears all statistics
+ * CycleProfiler::sites():       last registered site, follow Site::next for the others
+ *
+ * Don't record the same site from interrupts and the main loop at the same time, the
+ * statistics of a site are updated without locking.
+ ************************************************************************************/
+
+#include "Arduino.h"
+
+namespace CycleProfiler
+{
+    constexpr unsigned nrOfBuckets = 32; // bucket n counts durations in [2^n, 2^(n+1))
+
+    class Site
+    {
+     public:
+        constexpr Site(const char* _name) : name(_name) {}
+
+        void record(uint32_t cycles);
+        void reset();
+
+        const char* const name;
+        uint32_t count = 0;
+        uint32_t min   = UINT32_MAX;
+        uint32_t max   = 0;
+        uint64_t sum   = 0;
+        uint32_t histogram[nrOfBuckets]{};
+
+        Site* next      = nullptr;
+        bool registered = false;
+    };
+
+    class Scope
+    {
+     public:
+        Scope(Site& _site) : site(_site), start(ARM_DWT_CYCCNT) {}
+        ~Scope() { site.record(ARM_DWT_CYCCNT - start); }
+
+     protected:
+        Site& site;
+        const uint32_t start;
+    };
+
+    void begin(Stream& stream = Serial);
+    void report();
+    void reset();
+    uint32_t overhead(); // calibrated probe overhead in cycles
+    Site* sites();
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b)  PROFILE_CONCAT_(a, b)
+
+#define PROFILE_SCOPE(name)                                                    \
+    static CycleProfiler::Site PROFILE_CONCAT(profileSite_, __LINE__){(name)}; \
+    CycleProfiler::Scope PROFILE_CONCAT(profileScope_, __LINE__)(PROFILE_CONCAT(profileSite_, __LINE__))
+
+#define PROFILE_BEGIN(id, name)                             \
+    static CycleProfiler::Site profileSite_##id{(name)}; \
+    const uint32_t profileStart_##id = ARM_DWT_CYCCNT
+
+#define PROFILE_END(id) profileSite_##id.record(ARM_DWT_CYCCNT - profileStart_##id)
@@ -0,0 +1,205 @@
+#include "eventTrace.h"
+#include "attachYieldFunc.h"
+#include "criticalSection.h"
+#include "cycles64.h"
+
+namespace EventTrace
+{
+    namespace // private -----------------------------
+    {
+        static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "TRACE_BUFFER_SIZE needs to be a power of 2");
+        static_assert(MAX_TRACE_NAME <= 255 - 5 - 1, "name records need to fit the 8 bit record length");
+        constexpr uint32_t bufferMask    = TRACE_BUFFER_SIZE - 1;
+        constexpr unsigned maxEventBytes = 2 + 2 + 10 + 5; // header + length, exception number, time delta, id delta
+        constexpr unsigned lostBytes     = 2 + 5;          // header + length, number of lost events
+        constexpr uint8_t inHandlerFlag  = 0x80;           // header flag: recorded in an exception handler, exception number follows
+
+        uint8_t buffer[TRACE_BUFFER_SIZE];
+        volatile uint32_t head = 0; // free running, written by record() (interrupts disabled)
+        volatile uint32_t tail = 0; // free running, written by drain()
+
+        Stream* stream      = &Serial;
+        bool recording      = false;
+        int yieldTask       = 0;
+        uint64_t lastTime   = 0;
+        uint32_t lastId     = 0;
+        uint32_t lost       = 0; // dropped events which are not yet reported by a lost record
+        Stats stats{0, 0, 0, TRACE_BUFFER_SIZE};
+
+        inline uint32_t exceptionNumber() // 0: thread mode (loop), 16+n: IRQ n
+        {
+#if defined(__arm__)
+            uint32_t ipsr;
+            asm volatile("mrs %0, ipsr" : "=r"(ipsr));
+            return ipsr & 0x1FF;
+#else
+            return 0;
+#endif
+        }
+
+        // writes to the buffer at the local index h, the caller publishes h to head when the record is complete
+        inline void put(uint32_t& h, uint8_t b)
+        {
+            buffer[h++ & bufferMask] = b;
+        }
+
+        inline void putVarint(uint32_t& h, uint64_t v) // 7 bits per byte, MSB set: more bytes follow
+        {
+            while (v >= 0x80)
+            {
+                put(h, (uint8_t)v | 0x80);
+                v >>= 7;
+            }
+            put(h, (uint8_t)v);
+        }
+
+        // each record: type byte, payload length byte, payload. The length lets the parser skip
+        // records and detect broken ones, payload bytes can't be mistaken for record starts
+        inline uint32_t openRecord(uint32_t& h, uint8_t type)
+        {
+            put(h, type);
+            return h++; // position of the length byte
+        }
+
+        inline void closeRecord(uint32_t h, uint32_t lengthPos)
+        {
+            buffer[lengthPos & bufferMask] = (uint8_t)(h - lengthPos - 1);
+        }
+
+        inline uint32_t zigzag(int32_t v) // small negative differences -> small numbers
+        {
+            return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+        }
+
+        inline uint32_t freeSpace()
+        {
+            return TRACE_BUFFER_SIZE - (head - tail);
+        }
+
+        inline void publish(uint32_t h)
+        {
+            head          = h;
+            uint32_t used = h - tail;
+            if (used > stats.highWaterMark) stats.highWaterMark = used;
+        }
+    } // end private namespace <<---------------------
+
+    bool begin(Stream& s, bool drainFromYield)
+    {
+        cycles64::begin();
+
+        CriticalSection cs;
+        stream   = &s;
+        lastId   = 0;
+        lost     = 0;
+        lastTime = cycles64::get();
+
+        if (freeSpace() < 2 + 4 + 5 + 10) // still full of events from a previous recording
+        {
+            recording = false; // the deltas would refer to the reset lastId / lastTime
+            return false;
+        }
+
+        uint32_t h   = head;
+        uint32_t len = openRecord(h, (uint8_t)Type::start); // stream header: magic, F_CPU, start time
+        for (char c : {'E', 'T', 'R', '2'}) put(h, c);
+        putVarint(h, F_CPU);
+        putVarint(h, lastTime);
+        closeRecord(h, len);
+        publish(h);
+        recording = true;
+
+        if (drainFromYield && yieldTask == 0) yieldTask = YieldScheduler::addTask([] { drain(); });
+        return true;
+    }
+
+    void end()
+    {
+        recording = false;
+    }
+
+    void setName(uint32_t id, const char* name)
+    {
+        size_t len = strnlen(name, MAX_TRACE_NAME);
+
+        CriticalSection cs;
+        if (!recording || freeSpace() < 2 + 5 + 1 + len) return;
+
+        uint32_t h      = head;
+        uint32_t lenPos = openRecord(h, (uint8_t)Type::name);
+        putVarint(h, id);
+        putVarint(h, len);
+        for (size_t i = 0; i < len; i++) put(h, name[i]);
+        closeRecord(h, lenPos);
+        publish(h);
+    }
+
+    void record(Type type, uint32_t id)
+    {
+        if (!recording) return;
+
+        uint64_t now       = cycles64::get(); // outside of the critical section, get() might enable interrupts
+        uint32_t exception = exceptionNumber();
+
+        CriticalSection cs;
+        if (now < lastTime) now = lastTime; // an interrupt recorded an event in between, keep the order of the buffer
+
+        if (freeSpace() < maxEventBytes + (lost ? lostBytes : 0))
+        {
+            lost++;
+            stats.dropped++;
+            return;
+        }
+        uint32_t h = head;
+        uint32_t len;
+        if (lost) // report the dropped events before the next one
+        {
+            len = openRecord(h, (uint8_t)Type::lost);
+            putVarint(h, lost);
+            closeRecord(h, len);
+            lost = 0;
+        }
+
+        len = openRecord(h, (uint8_t)type | (exception ? inHandlerFlag : 0));
+        if (exception) putVarint(h, exception);
+        putVarint(h, now - lastTime);
+        putVarint(h, zigzag((int32_t)(id - lastId)));
+        closeRecord(h, len);
+
+        lastTime = now;
+        lastId   = id;
+        stats.events++;
+        publish(h);
+    }
+
+    unsigned drain()
+    {
+        uint32_t h = head; // only bytes of completed records, record() runs with interrupts disabled
+        uint32_t t = tail;
+        unsigned written = 0;
+
+        while (t != h)
+        {
+            int space = stream->availableForWrite();
+            if (space <= 0) break;
+
+            uint32_t start = t & bufferMask;
+            uint32_t chunk = h - t;
+            if (chunk > TRACE_BUFFER_SIZE - start) chunk = TRACE_BUFFER_SIZE - start; // up to the end of the buffer
+            if (chunk > (uint32_t)space) chunk = space;
+
+            size_t n = stream->write(buffer + start, chunk);
+            if (n == 0) break;
+            t += n;
+            written += n;
+            tail = t;
+        }
+        return written;
+    }
+
+    Stats getStats()
+    {
+        CriticalSection cs;
+        return stats;
+    }
+}
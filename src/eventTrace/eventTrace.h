@@ -0,0 +1,79 @@
+#pragma once
+/************************************************************************************
+ * Binary event trace recorder
+ *
+ * Records begin, end and instant events with cycles64 timestamps into a static ring
+ * buffer. Timestamps and ids are stored as differences to the previous event, encoded
+ * as varints. Each record carries its length, a typical event takes 4 to 6 bytes.
+ * The buffer is drained to a
+ * Stream in the background (from yield). Events can be recorded from interrupts and
+ * the main loop, the context (thread mode or exception number) is stored as well.
+ * Use traceToJson.py to convert the recorded stream to a Chrome/Perfetto trace.
+ *
+ * EventTrace::begin(stream):  starts recording and draining to the stream, false if the buffer
+ *                             is still full of a previous recording (drain it and try again)
+ * EventTrace::setName(id, n): defines the name of an event id (call after begin)
+ * TRACE_BEGIN(id) / TRACE_END(id), TRACE_INSTANT(id), TRACE_SCOPE(id)
+ *
+ * Needs cycles64 (teensy_clock folder), criticalSection and attachYieldFunc
+ ************************************************************************************/
+
+#include "Arduino.h"
+
+//#define EVENT_TRACE_OFF                 // uncomment to compile all TRACE_xx macros to nothing
+
+#define TRACE_BUFFER_SIZE 4096            // needs to be a power of 2
+#define MAX_TRACE_NAME 32
+
+namespace EventTrace
+{
+    enum class Type : uint8_t {
+        begin   = 0,
+        end     = 1,
+        instant = 2,
+        lost    = 3, // number of dropped events (buffer full)
+        name    = 4, // id -> name definition
+        start   = 5, // stream header: magic 'ETR2', F_CPU, start time
+    };
+
+    struct Stats
+    {
+        uint32_t events;        // recorded events
+        uint32_t dropped;       // events dropped since the buffer was full
+        uint32_t highWaterMark; // maximum number of buffered bytes
+        uint32_t capacity;      // TRACE_BUFFER_SIZE
+    };
+
+    bool begin(Stream& stream = Serial, bool drainFromYield = true); // drainFromYield = false: call drain() yourself
+    void end();                                                      // stops recording, buffered events are still drained
+    void setName(uint32_t id, const char* name);
+
+    void record(Type type, uint32_t id);
+    unsigned drain(); // writes as much as the stream accepts without blocking, returns the number of bytes written
+    Stats getStats();
+
+    class Scope
+    {
+     public:
+        Scope(uint32_t _id) : id(_id) { record(Type::begin, id); }
+        ~Scope() { record(Type::end, id); }
+
+     protected:
+        const uint32_t id;
+    };
+}
+
+#if defined(EVENT_TRACE_OFF)
+    #define TRACE_BEGIN(id)
+    #define TRACE_END(id)
+    #define TRACE_INSTANT(id)
+    #define TRACE_SCOPE(id)
+#else
+    #define TRACE_CONCAT_(a, b) a##b
+    #define TRACE_CONCAT(a, b)  TRACE_CONCAT_(a, b)
+
+    #define TRACE_BEGIN(id)   EventTrace::record(EventTrace::Type::begin, (id))
+    #define TRACE_END(id)     EventTrace::record(EventTrace::Type::end, (id))
+    #define TRACE_INSTANT(id) EventTrace::record(EventTrace::Type::instant, (id))
+    #define TRACE_SCOPE(id)   EventTrace::Scope TRACE_CONCAT(traceScope_, __LINE__)(id)
+#endif
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+Converts a binary EventTrace recording to a Chrome/Perfetto trace (JSON).
+
+usage: traceToJson.py trace.bin [trace.json]
+
+Capture the stream e.g. with 'cat /dev/ttyACM0 > trace.bin' and open the generated
+json file in ui.perfetto.dev or chrome://tracing. Events recorded in the loop show
+up as thread 'loop', events recorded in interrupts as 'IRQ n'.
+
+Each record is [type][payload length][payload]. Records which don't decode to exactly
+their length (e.g. after a transmission error) are skipped until two consecutive
+valid records are found again.
+"""
+import json
+import sys
+
+TYPES = {0: "B", 1: "E", 2: "i"}
+LOST, NAME, START = 3, 4, 5
+IN_HANDLER = 0x80
+MAGIC = b"ETR2"
+
+
+def varints(payload):
+    """decodes a payload which consists of varints only, None if it ends within a varint"""
+    values, v, shift = [], 0, 0
+    for b in payload:
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            values.append(v)
+            v, shift = 0, 0
+        elif shift > 63:
+            return None
+    return values if shift == 0 else None
+
+
+def parseRecord(data, pos):
+    """returns (header, payload fields, next position) of the record at pos, None if it is not a valid record"""
+    if pos + 2 > len(data):
+        return None
+    header, length = data[pos], data[pos + 1]
+    end = pos + 2 + length
+    if end > len(data):
+        return None
+    payload = bytes(data[pos + 2 : end])
+    kind = header & 0x7F
+
+    if kind == START:
+        if header != START or payload[:4] != MAGIC:
+            return None
+        fields = varints(payload[4:])
+        return (header, fields, end) if fields is not None and len(fields) == 2 else None
+    if kind == NAME:
+        if header & IN_HANDLER:
+            return None
+        for n in range(1, len(payload) + 1):  # id, length, then the name itself
+            head = varints(payload[:n])
+            if head is not None and len(head) == 2:
+                name = payload[n:]
+                return (header, head + [name], end) if head[1] == len(name) else None
+        return None
+    if kind == LOST:
+        fields = varints(payload)
+        return (header, fields, end) if header == LOST and fields is not None and len(fields) == 1 else None
+    if kind in TYPES:
+        fields = varints(payload)  # [exception], time delta, id delta
+        expected = 3 if header & IN_HANDLER else 2
+        return (header, fields, end) if fields is not None and len(fields) == expected else None
+    return None
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def threadName(exception):
+    if exception == 0:
+        return "loop"
+    return f"IRQ {exception - 16}" if exception >= 16 else f"exception {exception}"
+
+
+def records(data):
+    """yields the valid records, skips garbage byte by byte. After an error a record is
+    only accepted if the following record is valid as well. Returns the number of resyncs"""
+    pos, synced, resyncs = 0, True, 0
+    while pos < len(data):
+        rec = parseRecord(data, pos)
+        if rec is not None and not synced:
+            end = rec[2]
+            if end < len(data) and parseRecord(data, end) is None:
+                rec = None
+        if rec is None:
+            if synced and (pos + 2 > len(data) or pos + 2 + data[pos + 1] > len(data)):
+                break  # truncated last record
+            if synced:
+                resyncs += 1
+            synced = False
+            pos += 1
+            continue
+        synced = True
+        yield rec
+        pos = rec[2]
+    return resyncs
+
+
+def convert(data):
+    events, names, threads = [], {}, set()
+    fcpu, time, lastId, lost = None, 0, 0, 0
+
+    it = records(data)
+    resyncs = 0
+    while True:
+        try:
+            header, fields, _ = next(it)
+        except StopIteration as stop:
+            resyncs = stop.value or 0
+            break
+
+        kind = header & 0x7F
+        if kind == START:  # magic, F_CPU, start time
+            fcpu, time, lastId = fields[0], fields[1], 0
+            continue
+        if fcpu is None:  # wait for the first stream header
+            continue
+
+        if kind == NAME:
+            names[fields[0]] = fields[2].decode(errors="replace")
+            continue
+        if kind == LOST:
+            lost += fields[0]
+            events.append({"name": f"lost {fields[0]} events", "ph": "i", "s": "g", "ts": time * 1e6 / fcpu, "pid": 0, "tid": 0})
+            continue
+
+        tid = fields.pop(0) if header & IN_HANDLER else 0  # exception number
+        time += fields[0]
+        lastId = (lastId + unzigzag(fields[1])) & 0xFFFFFFFF
+        threads.add(tid)
+
+        ev = {"name": names.get(lastId, str(lastId)), "ph": TYPES[kind], "ts": time * 1e6 / fcpu, "pid": 0, "tid": tid}
+        if kind == 2:
+            ev["s"] = "t"
+        events.append(ev)
+
+    for tid in sorted(threads):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": tid, "args": {"name": threadName(tid)}})
+    return {"traceEvents": events, "displayTimeUnit": "ns"}, lost, resyncs
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        trace, lost, resyncs = convert(f.read())
+
+    out = sys.argv[2] if len(sys.argv) > 2 else sys.argv[1].rsplit(".", 1)[0] + ".json"
+    with open(out, "w") as f:
+        json.dump(trace, f)
+
+    print(f"{len(trace['traceEvents'])} events -> {out}" + (f" ({lost} events lost)" if lost else "") + (f" ({resyncs} broken records skipped)" if resyncs else ""))
+
+
+if __name__ == "__main__":
+    main()
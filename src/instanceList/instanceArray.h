@@ -0,0 +1,157 @@
+#pragma once
+
+#include "instanceList.h"
+#include <cstddef>
+
+/**
+ * InstanceArray is a drop in alternative to InstanceList. Instead of chaining the
+ * instances it keeps pointers to them in a dense, contiguous array which is much
+ * more cache friendly if you tick hundreds of objects. Removal swaps the last entry
+ * into the freed slot (O(1)), i.e. the order of the instances is not preserved.
+ *
+ * class myClass : protected InstanceArray<myClass, 100>
+ *
+ * Optionally, frequently used ("hot") fields can be stored in a dense array as well:
+ *
+ * struct Hot { float x, v; };
+ * class myClass : protected InstanceArray<myClass, 100, Hot>   // hot() returns the instance's Hot
+ *
+ * Instances constructed while the array is full are not registered (registered()
+ * returns false). They are not visited and their hot() returns a shared dummy, i.e.
+ * writes to it don't crash but are lost. Adding and removing is interrupt safe, but
+ * must not happen during a traversal.
+ */
+
+namespace InstanceListDetail
+{
+    struct NoHotFields
+    {
+    };
+}
+
+template <class T, size_t capacity, class Hot = InstanceListDetail::NoHotFields>
+class InstanceArray
+{
+ protected:
+    /**
+     * Constructor
+     * Appends the instance to the array
+     */
+    InstanceArray()
+    {
+        CriticalSection cs;
+        if (count < capacity)
+        {
+            index          = count++;
+            items[index]   = this;
+            hotData[index] = Hot{};
+        }
+    }
+
+    InstanceArray(const InstanceArray&) : InstanceArray() {} // a copy is a new instance
+    InstanceArray& operator=(const InstanceArray&) { return *this; }
+
+    /**
+     * Destructor
+     * Moves the last instance into the freed slot
+     * */
+    ~InstanceArray()
+    {
+        CriticalSection cs;
+        if (index >= count) return; // not registered
+
+        size_t last = --count;
+        if (index != last)
+        {
+            items[index]        = items[last];
+            hotData[index]      = hotData[last];
+            items[index]->index = index;
+        }
+    }
+
+    Hot& hot() { return index < capacity ? hotData[index] : unregisteredHot; }
+    bool registered() const { return index < capacity; }
+
+    /**
+     * Calls f(T&) for all instances. Simple counted loop over contiguous memory which
+     * the compiler can unroll
+     */
+    template <typename F>
+    static void for_each(F&& f)
+    {
+        const size_t n = count;
+        for (size_t i = 0; i < n; i++) f(*static_cast<T*>(items[i]));
+    }
+
+    /**
+     * Calls f(Hot&) for the hot fields of all instances, doesn't touch the instances at all
+     */
+    template <typename F>
+    static void for_each_hot(F&& f)
+    {
+        const size_t n = count;
+        for (size_t i = 0; i < n; i++) f(hotData[i]);
+    }
+
+    static size_t size() { return count; }
+
+    //-----------------------
+
+    struct Iterator
+    {
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = T;
+        using pointer           = T*;
+        using reference         = T&;
+
+        Iterator(InstanceArray** ptr) : item(ptr) {}
+
+        T& operator*() const { return *static_cast<T*>(*item); }
+        T* operator->() { return static_cast<T*>(*item); }
+
+        // Prefix increment
+        Iterator& operator++()
+        {
+            ++item;
+            return *this;
+        }
+
+        // Postfix increment
+        Iterator operator++(int)
+        {
+            Iterator tmp = item;
+            ++item;
+            return tmp;
+        }
+
+        InstanceArray** item;
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.item == b.item; };
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.item != b.item; };
+    };
+
+    static struct
+    {
+        Iterator begin() { return Iterator(items); }
+        Iterator end() { return Iterator(items + count); }
+    } instanceList;
+
+ private:
+    size_t index = capacity; // position in the array, capacity: not registered
+
+    static InstanceArray* items[capacity];
+    static Hot hotData[capacity];
+    static Hot unregisteredHot; // hot() of instances which didn't fit into the array
+    static volatile size_t count;
+};
+
+template <class T, size_t capacity, class Hot>
+InstanceArray<T, capacity, Hot>* InstanceArray<T, capacity, Hot>::items[capacity];
+
+template <class T, size_t capacity, class Hot>
+Hot InstanceArray<T, capacity, Hot>::hotData[capacity];
+
+template <class T, size_t capacity, class Hot>
+Hot InstanceArray<T, capacity, Hot>::unregisteredHot;
+
+template <class T, size_t capacity, class Hot>
+volatile size_t InstanceArray<T, capacity, Hot>::count = 0;
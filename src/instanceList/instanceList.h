@@ -1,11 +1,27 @@
 #pragma once
 
+#include "criticalSection.h"
+#include <cstdint>
 #include <iterator>
+
 /**
  * InstanceList automatically maintains a linked list of instances of child classes.
  * If you want to add an InstanceList to your class simply derive it from InstanceList
 
  * class myClass : protected InstanceList<myClass>
+ *
+ * The list is doubly linked, i.e. adding and removing an instance is O(1). Links are
+ * changed with interrupts disabled, so creating and destroying instances from interrupts
+ * never corrupts the list itself. This doesn't make traversal safe in general:
+ *  - A traversal in the loop tolerates interrupts which create instances (they are added
+ *    in front and not visited) or destroy instances other than the one the loop is
+ *    currently working on.
+ *  - A node is linked before the constructor of T runs and unlinked after the destructor
+ *    of T finished. A traversal from an interrupt (e.g. a timer tick) can see a partially
+ *    constructed or destroyed T if the loop creates or destroys instances at the same
+ *    time. Disable interrupts around construction/destruction in this case.
+ *
+ * Copies are new instances with their own links, assigning doesn't change the links.
  */
 template <class T>
 class InstanceList
@@ -17,36 +33,34 @@ class InstanceList
      */
     InstanceList()
     {
-        InstanceList* tmp = first;
-        first             = this;
-        first->next       = tmp;
+        CriticalSection cs;
+        prev = nullptr;
+        next = first;
+        if (first != nullptr) first->prev = this;
+        first = this;
     }
 
+    InstanceList(const InstanceList&) : InstanceList() {}          // a copy is a new instance
+    InstanceList& operator=(const InstanceList&) { return *this; } // keeps the own links
+
     /**
      * Destructor
      * Removes the instance from the linked list
      * */
     ~InstanceList()
     {
-        if (this == first)
-        {
-            first = this->next;
-        }
+        CriticalSection cs;
+        if (prev != nullptr)
+            prev->next = next;
         else
-        {
-            for (auto& node : instanceList)
-            {
-                if (node.next == this)
-                {
-                    node.next = this->next;
-                    break;
-                }
-            }
-        }
+            first = next;
+
+        if (next != nullptr) next->prev = prev;
     }
 
-    static InstanceList* first;
-    InstanceList* next;
+    static InstanceList* volatile first;
+    InstanceList* volatile next;
+    InstanceList* prev;
 
     //-----------------------
 
@@ -90,4 +104,4 @@ class InstanceList
 };
 
 template <class T>
-InstanceList<T>* InstanceList<T>::first = nullptr;
+InstanceList<T>* volatile InstanceList<T>::first = nullptr;
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+Decodes binary MemoryTool reports (writeMemoryInfo / MemoryTool::encode).
+
+usage: decodeReport.py report.bin [source files...]
+
+Records only contain a hash of the variable names. To print the names, pass the
+sources of your sketch, all identifiers found in them are hashed and matched.
+Unmatched names are printed as their hash.
+"""
+import re
+import struct
+import sys
+
+MAGIC = 0x544D
+RECORD = struct.Struct("<HBBIII")
+
+REGIONS = [
+    "unknown",
+    "ITCM (Code copied to RAM-1)",
+    "DTCM (initialized, RAM-1)",
+    "DTCM (zeroed, RAM-1)",
+    "STACK (on RAM-1)",
+    "DMAMEM (not initialized, RAM-2)",
+    "HEAP (on RAM-2)",
+    "FLASH",
+    "EXTMEM (PSRAM)",
+]
+
+
+def fnv1a(name):
+    h = 2166136261
+    for b in name.encode():
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def read_names(files):
+    names = {}
+    for fn in files:
+        with open(fn, errors="ignore") as f:
+            for ident in re.findall(r"[A-Za-z_]\w*(?:(?:\.|->)[A-Za-z_]\w*)*", f.read()):
+                names[fnv1a(ident)] = ident
+    return names
+
+
+def ptr2hex(p):
+    return "0x%04X'%04X" % (p >> 16, p & 0xFFFF)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    data = open(sys.argv[1], "rb").read()
+    names = read_names(sys.argv[2:])
+
+    pos = 0
+    while pos + RECORD.size <= len(data):
+        magic, region, flags, hash, start, size = RECORD.unpack_from(data, pos)
+        if magic != MAGIC:  # resync
+            pos += 1
+            continue
+        pos += RECORD.size
+
+        print(names.get(hash, "#%08X" % hash))
+        print("  Start address: %s" % ptr2hex(start))
+        if flags & 1:
+            print("  End address:   n.a")
+            print("  Size:          n.a.")
+        else:
+            print("  End address:   %s" % ptr2hex(start + size - 1))
+            print("  Size:          %d Bytes" % size)
+        print("  Location:      %s" % (REGIONS[region] if region < len(REGIONS) else "unknown"))
+        print()
+
+
+if __name__ == "__main__":
+    main()
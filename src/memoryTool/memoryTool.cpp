@@ -1,5 +1,9 @@
 #include "memoryTool.h"
+#include "criticalSection.h"
 #include "Stream.h"
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
 
 namespace MemoryTool
 {
@@ -18,8 +22,22 @@ namespace MemoryTool
         unsigned long _estack;
         unsigned long _heap_end;
         unsigned long _heap_start;
+        extern char* __brkval; // current end of the heap (sbrk)
+        extern MallocChunk* __malloc_av_[]; // newlib malloc bins
         }
 
+#if defined(ARDUINO_TEENSY40) || defined(ARDUINO_TEENSY41)
+        constexpr uint32_t stackPattern = 0xDEAD'BEEF;
+        uint32_t* stackMark = nullptr; // lowest used stack word found so far (stack grows down), nullptr: stack not painted
+
+        inline uint32_t* currentSP()
+        {
+            uint32_t* sp;
+            asm volatile("mov %0, sp" : "=r"(sp));
+            return sp;
+        }
+#endif
+
         // pretty print a pointer into a char buffer
         void ptr2hex(const uintptr_t p, char* buf, size_t bufSize)
         {
@@ -31,86 +49,12 @@ namespace MemoryTool
 
     void doPrintT4(const char* name, const void* startPtr, uint32_t elemSize, uint32_t elements = 1)
     {
-        char startAddr[20], endAddr[20], location[30] = "unknown";
+        char startAddr[20], endAddr[20];
 
         uint32_t size   = elemSize * elements;
         uintptr_t start = (uintptr_t)startPtr;
         uintptr_t end   = start + size - 1;
 
-#if defined(ARDUINO_TEENSY40) || defined(ARDUINO_TEENSY41)
-        uint32_t flashS      = 0x6000'0000;
-        uint32_t initVarsS   = (uint32_t)&_sdata;
-        uint32_t zeroedVarsS = (uint32_t)&_sbss;
-        uint32_t stackEnd    = (uint32_t)&_estack;
-        uint32_t heapS       = (uint32_t)&_heap_start;
-        uint32_t ramS        = 0x2020'0000;
-
-        if (start >= flashS)
-        {
-            snprintf(location, sizeof(location), "FLASH");
-        }
-        else if (start >= heapS)
-        {
-            snprintf(location, sizeof(location), "HEAP (on RAM-2)");
-        }
-        else if (start >= ramS)
-        {
-            snprintf(location, sizeof(location), "DMAMEM (not initialized, RAM-2)");
-        }
-        else if (start >= stackEnd)
-        {
-            snprintf(location, sizeof(location), "STACK (on RAM-1)");
-        }
-        else if (start >= zeroedVarsS)
-        {
-            snprintf(location, sizeof(location), "DTCM (initialized, RAM-1)");
-        }
-        else if (start >= initVarsS)
-        {
-            snprintf(location, sizeof(location), "DTCM (zeroed, RAM-1)");
-        }
-        else
-        {
-            snprintf(location, sizeof(location), "ITCM (Code copied to RAM-1)");
-        }
-
-#elif defined(ARDUINO_TEENSYLC) || defined(ARDUINO_TEENSY31) || defined(ARDUINO_TEENSY35) || defined(ARDUINO_TEENSY36)
-
-        uint32_t initVarsS   = (uint32_t)&_sdata;
-        uint32_t zeroedVarsS = (uint32_t)&_sbss;
-        //uint32_t stackEnd    = (uint32_t)&_estack;
-        uint32_t heapS = (uint32_t)&_heap_start;
-
-        char dummy;
-
-        stream->printf("dummy:      0x%08X\n", &dummy);
-        stream->printf("heap:   0x%08X\n", heapS);
-        stream->printf("initVars:   0x%08X\n", initVarsS);
-        stream->printf("zeroVars:   0x%08X\n", zeroedVarsS);
-
-        if (start >= (uintptr_t)&dummy)
-        {
-            snprintf(location, sizeof(location), "STACK");
-        }
-        else if (start >= heapS)
-        {
-            snprintf(location, sizeof(location), "HEAP");
-        }
-        else if (start >= zeroedVarsS)
-        {
-            snprintf(location, sizeof(location), "RAM (zeroed)");
-        }
-        else if (start >= initVarsS)
-        {
-            snprintf(location, sizeof(location), "RAM (initialized)");
-        }
-        else
-        {
-            snprintf(location, sizeof(location), "FLASH");
-        }
-
-#endif
-
         // stream->printf("dataStart:   0x%08X\n", dataStart);
         // stream->printf("ramStart:   0x%08X\n", ramstart);
 
@@ -129,7 +73,7 @@ namespace MemoryTool
             stream->printf("  End address:   %s\n", endAddr);
             stream->printf("  Size:          %d Bytes\n", size);
         }
-        stream->printf("  Location:      %s\n", location);
+        stream->printf("  Location:      %s\n", regionName(classify(startPtr)));
 
         stream->println();
     }
@@ -186,6 +130,143 @@ namespace MemoryTool
         // stream->println();
     }
 
+    void paintStack()
+    {
+#if defined(ARDUINO_TEENSY40) || defined(ARDUINO_TEENSY41)
+        volatile uint32_t* p   = (uint32_t*)&_ebss;
+        volatile uint32_t* end = currentSP() - 16; // keep some distance to the current frame
+
+        while (p < end) *p++ = stackPattern;
+        stackMark = (uint32_t*)end;
+#endif
+    }
+
+    Snapshot getSnapshot()
+    {
+        Snapshot s{};
+
+#if defined(ARDUINO_TEENSY40) || defined(ARDUINO_TEENSY41)
+        uint32_t stackTop    = (uint32_t)&_estack;
+        uint32_t stackBottom = (uint32_t)&_ebss;
+        uint32_t* sp         = currentSP();
+
+        s.stackSize = stackTop - stackBottom;
+        s.stackUsed = stackTop - (uint32_t)sp;
+
+        if (stackMark != nullptr) // scan up from the bottom to the first overwritten word. Frames may contain
+        {                         // untouched words (e.g. buffers), so a scan down from the last mark could stop early
+            uint32_t* limit = sp < stackMark ? sp : stackMark;
+            uint32_t* p     = (uint32_t*)stackBottom;
+            while (p < limit && *p == stackPattern) p++;
+            stackMark      = p;
+            s.stackMaxUsed = stackTop - (uint32_t)p;
+        }
+        else
+        {
+            s.stackMaxUsed = s.stackUsed;
+        }
+
+        struct mallinfo mi   = mallinfo();
+        uint32_t heapStart   = (uint32_t)&_heap_start;
+        uint32_t heapEnd     = (uint32_t)&_heap_end;
+        uint32_t untouched   = heapEnd - (uint32_t)__brkval; // never requested from sbrk
+
+        s.heapSize    = heapEnd - heapStart;
+        s.heapUsed    = mi.uordblks;
+        s.heapFree    = mi.fordblks + untouched;
+        s.heapTopFree = mi.keepcost + untouched;             // top chunk is contiguous with the untouched area
+        if (s.heapTopFree > s.heapFree) s.heapTopFree = s.heapFree;
+
+        uint32_t largestChunk = largestFreeChunk(__malloc_av_);
+        s.heapLargestFree     = largestChunk > s.heapTopFree ? largestChunk : s.heapTopFree;
+        s.fragmentation       = fragmentation(s.heapLargestFree, s.heapFree);
+#endif
+        return s;
+    }
+
+    uint32_t largestFreeChunk(MallocChunk* const* av, unsigned bins)
+    {
+        constexpr unsigned maxChunks = 10'000; // stop on a corrupted list instead of looping forever
+
+        size_t largest = 0;
+        unsigned n     = 0;
+        for (unsigned i = 1; i < bins; i++)
+        {
+            // bin header: a fake chunk whose fd/bk fields are the pair av[2i+2], av[2i+3]
+            const MallocChunk* bin = (const MallocChunk*)((const uint8_t*)&av[2 * i + 2] - offsetof(MallocChunk, fd));
+            for (const MallocChunk* p = bin->fd; p != bin && p != nullptr && n < maxChunks; p = p->fd, n++)
+            {
+                size_t size = p->size & ~(size_t)3;
+                if (size > largest) largest = size;
+            }
+        }
+        return largest > sizeof(size_t) ? largest - sizeof(size_t) : 0; // usable bytes: chunk minus its size field
+    }
+
+    uint32_t fragmentation(uint32_t largestFree, uint32_t free)
+    {
+        return free != 0 ? 100 - (uint32_t)((uint64_t)largestFree * 100 / free) : 0;
+    }
+
+    void printSnapshot(const Snapshot& s)
+    {
+        stream->printf("Stack: %lu / %lu Bytes used (max: %lu)\n", s.stackUsed, s.stackSize, s.stackMaxUsed);
+        stream->printf("Heap:  %lu / %lu Bytes used, %lu free (top block: %lu, largest block: %lu, fragmentation: %lu%%)\n",
+                       s.heapUsed, s.heapSize, s.heapFree, s.heapTopFree, s.heapLargestFree, s.fragmentation);
+    }
+
+    Region classify(const void* ptr)
+    {
+        [[maybe_unused]] uintptr_t start = (uintptr_t)ptr;
+
+#if defined(ARDUINO_TEENSY40) || defined(ARDUINO_TEENSY41)
+        Region region = regionOf(start).region;
+        if (region == Region::dmamem) // OCRAM: DMAMEM variables below the heap
+        {
+            return start >= (uint32_t)&_heap_start ? Region::heap : Region::dmamem;
+        }
+        if (region == Region::dataInit) // DTCM: initialized and zeroed variables, stack
+        {
+            if (start >= (uint32_t)&_estack) return Region::unknown;
+            if (start >= (uint32_t)&_ebss) return Region::stack;
+            if (start >= (uint32_t)&_sbss) return Region::dataZeroed;
+        }
+        return region;
+
+#elif defined(ARDUINO_TEENSYLC) || defined(ARDUINO_TEENSY31) || defined(ARDUINO_TEENSY35) || defined(ARDUINO_TEENSY36)
+        char dummy;
+        if (start >= (uintptr_t)&dummy) return Region::stack;
+        if (start >= (uint32_t)&_heap_start) return Region::heap;
+        if (start >= (uint32_t)&_sbss) return Region::dataZeroed;
+        if (start >= (uint32_t)&_sdata) return Region::dataInit;
+        return Region::flash;
+#else
+        return Region::unknown;
+#endif
+    }
+
+    size_t encode(const char* name, const void* startPtr, uint32_t elemSize, uint32_t elements, uint8_t* buffer, size_t bufSize)
+    {
+        if (bufSize < sizeof(Record)) return 0;
+
+        Record r;
+        r.magic    = recordMagic;
+        r.region   = (uint8_t)classify(startPtr);
+        r.flags    = elemSize == 0 ? 1 : 0;
+        r.nameHash = nameHash(name);
+        r.start    = (uint32_t)(uintptr_t)startPtr;
+        r.size     = elemSize * elements;
+
+        memcpy(buffer, &r, sizeof(Record));
+        return sizeof(Record);
+    }
+
+    void doWrite(const char* name, const void* startPtr, uint32_t elemSize, uint32_t elements)
+    {
+        uint8_t buf[sizeof(Record)];
+        stream->write(buf, encode(name, startPtr, elemSize, elements, buf, sizeof(buf)));
+    }
+
     void begin(Stream& _stream)
     {
         stream = &_stream;
@@ -205,4 +286,327 @@ namespace MemoryTool
         //stream->printf("dataEnd:     0x%08X\n", data);
     }
 
-}
\ No newline at end of file
+    void setStream(Stream& _stream)
+    {
+        stream = &_stream;
+    }
+
+    Stream& getStream()
+    {
+        return *stream;
+    }
+
+    //-------------------------------------------------------------------------------
+    // allocation tracker
+
+    namespace // private
+    {
+        static_assert((ALLOCATION_SITES & (ALLOCATION_SITES - 1)) == 0, "ALLOCATION_SITES needs to be a power of 2");
+        static_assert(ALLOCATION_SITES < 0xFFFF, "ALLOCATION_SITES too large");
+
+        constexpr uint16_t noSite     = 0xFFFF;
+        constexpr uint16_t blockMagic = 0xA10C;
+
+        struct BlockHeader // prepended to each tracked block
+        {
+            uint32_t size;
+            uint16_t site;  // index into the site table or noSite
+            uint16_t magic; // blockMagic, cleared when the block is freed
+        };
+        constexpr size_t headerSize = (sizeof(BlockHeader) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1); // keep malloc alignment
+
+        AllocationSite sites[ALLOCATION_SITES];
+        AllocationSite sortedSites[ALLOCATION_SITES]; // copy for printAllocationSites, too large (~1.5kB) for the stack
+        AllocationStats allocStats{};
+        volatile uint32_t noAllocDepth = 0;
+        bool trapForbidden             = false;
+
+        inline bool inHandler()
+        {
+#if defined(__arm__)
+            uint32_t ipsr;
+            asm volatile("mrs %0, ipsr" : "=r"(ipsr));
+            return (ipsr & 0x1FF) != 0;
+#elif defined(ARDUINO_TEENSY_SIM)
+            return sim::inHandler();
+#else
+            return false;
+#endif
+        }
+
+        inline uint32_t callSite(void* returnAddress)
+        {
+            return (uint32_t)(uintptr_t)returnAddress & ~1u; // clear the thumb bit
+        }
+
+        uint16_t findSite(uint32_t caller) // open addressing, linear probing. Call with interrupts disabled
+        {
+            uint32_t h = caller * 2654435761u;
+            h ^= h >> 16;
+
+            for (unsigned i = 0; i < ALLOCATION_SITES; i++)
+            {
+                uint16_t idx = (h + i) & (ALLOCATION_SITES - 1);
+                if (sites[idx].caller == caller) return idx;
+                if (sites[idx].caller == 0)
+                {
+                    sites[idx]        = AllocationSite{};
+                    sites[idx].caller = caller;
+                    allocStats.sites++;
+                    return idx;
+                }
+            }
+            return noSite;
+        }
+
+        void checkForbidden(uint32_t caller)
+        {
+            if (noAllocDepth == 0 && !inHandler()) return;
+
+            allocStats.forbidden++;
+            allocStats.lastForbidden = caller;
+            if (trapForbidden) __builtin_trap();
+        }
+
+#if defined(USE_ALLOCATION_TRACKER_MALLOC) // malloc & co are wrapped by the linker, the original functions are __real_xxx
+        extern "C" {
+        void* __real_malloc(size_t);
+        void __real_free(void*);
+        void* __real_realloc(void*, size_t);
+        }
+        inline void* rawMalloc(size_t size) { return __real_malloc(size); }
+        inline void rawFree(void* ptr) { __real_free(ptr); }
+        inline void* rawRealloc(void* ptr, size_t size) { return __real_realloc(ptr, size); }
+#else
+        inline void* rawMalloc(size_t size) { return malloc(size); }
+        inline void rawFree(void* ptr) { free(ptr); }
+        inline void* rawRealloc(void* ptr, size_t size) { return realloc(ptr, size); }
+#endif
+    } // end private namespace
+
+    // used by the replaced allocation functions below
+
+    void* trackedAlloc(size_t size, uint32_t caller)
+    {
+        checkForbidden(caller);
+
+        BlockHeader* b = (BlockHeader*)rawMalloc(headerSize + size);
+        if (b == nullptr) return nullptr;
+        b->size  = size;
+        b->magic = blockMagic;
+
+        CriticalSection cs;
+        b->site = findSite(caller);
+        allocStats.allocs++;
+        allocStats.liveBytes += size;
+        if (allocStats.liveBytes > allocStats.peakBytes) allocStats.peakBytes = allocStats.liveBytes;
+
+        if (b->site == noSite)
+        {
+            allocStats.untracked++;
+        }
+        else
+        {
+            AllocationSite& s = sites[b->site];
+            s.allocs++;
+            s.totalBytes += size;
+            s.liveBytes += size;
+            if (s.liveBytes > s.peakBytes) s.peakBytes = s.liveBytes;
+        }
+        return (uint8_t*)b + headerSize;
+    }
+
+    void trackedFree(void* ptr)
+    {
+        if (ptr == nullptr) return;
+
+        BlockHeader* b = (BlockHeader*)((uint8_t*)ptr - headerSize);
+        if (b->magic != blockMagic) // not allocated by the tracker
+        {
+            rawFree(ptr);
+            return;
+        }
+
+        {
+            CriticalSection cs;
+            b->magic = 0;
+            allocStats.frees++;
+            allocStats.liveBytes -= b->size;
+            if (b->site != noSite)
+            {
+                sites[b->site].frees++;
+                sites[b->site].liveBytes -= b->size;
+            }
+        }
+        rawFree(b);
+    }
+
+    void* trackedRealloc(void* ptr, size_t size, uint32_t caller)
+    {
+        if (ptr == nullptr) return trackedAlloc(size, caller);
+        if (size == 0)
+        {
+            trackedFree(ptr);
+            return nullptr;
+        }
+
+        BlockHeader* b = (BlockHeader*)((uint8_t*)ptr - headerSize);
+        if (b->magic != blockMagic) return rawRealloc(ptr, size);
+
+        checkForbidden(caller);
+        uint32_t oldSize = b->size;
+        b                = (BlockHeader*)rawRealloc(b, headerSize + size); // grows or shrinks in place if possible, copies the header otherwise
+        if (b == nullptr) return nullptr;                                  // the old block is still valid
+        b->size = size;
+
+        CriticalSection cs; // the block keeps its call site, only the size changes
+        allocStats.liveBytes += size - oldSize;
+        if (allocStats.liveBytes > allocStats.peakBytes) allocStats.peakBytes = allocStats.liveBytes;
+        if (b->site != noSite)
+        {
+            AllocationSite& s = sites[b->site];
+            if (size > oldSize) s.totalBytes += size - oldSize;
+            s.liveBytes += size - oldSize;
+            if (s.liveBytes > s.peakBytes) s.peakBytes = s.liveBytes;
+        }
+        return (uint8_t*)b + headerSize;
+    }
+
+    void* trackedNew(size_t size, uint32_t caller) // throwing new: never returns nullptr
+    {
+        while (true)
+        {
+            void* p = trackedAlloc(size, caller);
+            if (p != nullptr) return p;
+
+            std::new_handler handler = std::get_new_handler(); // may free memory and return, or throw / abort
+            if (handler == nullptr)
+            {
+#if defined(__cpp_exceptions)
+                throw std::bad_alloc();
+#else
+                abort();
+#endif
+            }
+            handler();
+        }
+    }
+
+    AllocationStats getAllocationStats()
+    {
+        CriticalSection cs;
+        return allocStats;
+    }
+
+    unsigned getAllocationSites(AllocationSite* out, unsigned maxSites)
+    {
+        unsigned n = 0;
+        CriticalSection cs; // consistent copy, ~1.5kB
+        for (unsigned i = 0; i < ALLOCATION_SITES && n < maxSites; i++)
+        {
+            if (sites[i].caller != 0) out[n++] = sites[i];
+        }
+        return n;
+    }
+
+    void printAllocationSites() // not reentrant, uses a static copy of the table
+    {
+        AllocationSite* s = sortedSites;
+        AllocationStats st;
+        unsigned n;
+        {
+            CriticalSection cs; // sites and totals of the same moment
+            n  = getAllocationSites(s, ALLOCATION_SITES);
+            st = allocStats;
+        }
+
+        for (unsigned i = 1; i < n; i++) // insertion sort, largest live bytes first
+        {
+            AllocationSite tmp = s[i];
+            unsigned j         = i;
+            for (; j > 0 && s[j - 1].liveBytes < tmp.liveBytes; j--) s[j] = s[j - 1];
+            s[j] = tmp;
+        }
+
+        stream->printf("Allocations: %lu, frees: %lu, live: %lu Bytes (peak: %lu), forbidden: %lu, untracked: %lu\n",
+                       st.allocs, st.frees, st.liveBytes, st.peakBytes, st.forbidden, st.untracked);
+        if (st.forbidden) stream->printf("last forbidden allocation from 0x%08lX\n", st.lastForbidden);
+
+        stream->printf("caller        allocs    frees      total       live       peak\n");
+        for (unsigned i = 0; i < n; i++)
+        {
+            stream->printf("0x%08lX %9lu %8lu %10lu %10lu %10lu\n",
+                           s[i].caller, s[i].allocs, s[i].frees, s[i].totalBytes, s[i].liveBytes, s[i].peakBytes);
+        }
+    }
+
+    void resetAllocationStats()
+    {
+        CriticalSection cs;
+        for (AllocationSite& s : sites)
+        {
+            s.allocs = s.frees = s.totalBytes = 0;
+            s.peakBytes                       = s.liveBytes;
+        }
+        allocStats.allocs = allocStats.frees = allocStats.forbidden = allocStats.untracked = 0;
+        allocStats.lastForbidden                                      = 0;
+        allocStats.peakBytes                                          = allocStats.liveBytes;
+    }
+
+    void setAllocationTrap(bool trap)
+    {
+        trapForbidden = trap;
+    }
+
+    NoAllocScope::NoAllocScope()
+    {
+        noAllocDepth++;
+    }
+
+    NoAllocScope::~NoAllocScope()
+    {
+        noAllocDepth--;
+    }
+}
+
+#if defined(USE_ALLOCATION_TRACKER) // replaces the global allocation functions
+
+void* operator new(size_t size) { return MemoryTool::trackedNew(size, MemoryTool::callSite(__builtin_return_address(0))); }
+void* operator new[](size_t size) { return MemoryTool::trackedNew(size, MemoryTool::callSite(__builtin_return_address(0))); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return MemoryTool::trackedAlloc(size, MemoryTool::callSite(__builtin_return_address(0))); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return MemoryTool::trackedAlloc(size, MemoryTool::callSite(__builtin_return_address(0))); }
+
+void operator delete(void* ptr) noexcept { MemoryTool::trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { MemoryTool::trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { MemoryTool::trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { MemoryTool::trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { MemoryTool::trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { MemoryTool::trackedFree(ptr); }
+
+#if defined(USE_ALLOCATION_TRACKER_MALLOC) // needs -Wl,--wrap=malloc,--wrap=free,--wrap=calloc,--wrap=realloc
+extern "C" {
+void* __wrap_malloc(size_t size)
+{
+    return MemoryTool::trackedAlloc(size, MemoryTool::callSite(__builtin_return_address(0)));
+}
+
+void __wrap_free(void* ptr)
+{
+    MemoryTool::trackedFree(ptr);
+}
+
+void* __wrap_calloc(size_t n, size_t size)
+{
+    if (size != 0 && n > SIZE_MAX / size) return nullptr;
+    void* p = MemoryTool::trackedAlloc(n * size, MemoryTool::callSite(__builtin_return_address(0)));
+    if (p != nullptr) memset(p, 0, n * size);
+    return p;
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+    return MemoryTool::trackedRealloc(ptr, size, MemoryTool::callSite(__builtin_return_address(0)));
+}
+}
+#endif
+#endif
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "arduino.h"
 #include <cstddef>
 #include <cstdint>
@@ -8,6 +10,7 @@ namespace MemoryTool
     void begin(Stream& stream = Serial);
 
     void setStream(Stream&);
+    Stream& getStream();
 
     // don't use in user code
     void doPrint(const char* name, const void* start, uint32_t elemSize, uint32_t elements);
@@ -33,6 +36,252 @@ namespace MemoryTool
     {
         doPrintT4(name, (void*)&f, 0, 0);
     }
+
+    // runtime telemetry (T4.x) -----------------------------------------------------
+
+    struct Snapshot
+    {
+        uint32_t stackSize;        // space between the end of the variables in RAM-1 and the stack top
+        uint32_t stackUsed;        // currently used
+        uint32_t stackMaxUsed;     // high water mark since paintStack(), lowest overwritten pattern word
+        uint32_t heapSize;         // _heap_end - _heap_start (RAM-2)
+        uint32_t heapUsed;         // allocated bytes
+        uint32_t heapFree;         // free bytes, including the part which was never requested from sbrk
+        uint32_t heapTopFree;      // free block at the top of the heap (top chunk + never requested)
+        uint32_t heapLargestFree;  // largest free block (top block or a freed chunk from the free lists), allocations up to this size succeed
+        uint32_t fragmentation;    // 100 * (1 - heapLargestFree / heapFree) in %
+    };
+
+    void paintStack();            // fills the unused stack with a pattern, call once early in setup()
+    Snapshot getSnapshot();       // no formatting, scans the unused stack (~1 cycle per unused byte / 4). Can be sampled periodically
+    void printSnapshot(const Snapshot& snapshot);
+
+    // don't use in user code. Walks the free lists of the newlib malloc (__malloc_av_: one fd/bk
+    // pair per bin, bin 0 holds the top chunk which is skipped) and returns the usable size of the
+    // largest free chunk
+    struct MallocChunk
+    {
+        size_t prevSize;
+        size_t size; // chunk size, bit 0: previous chunk in use
+        MallocChunk* fd;
+        MallocChunk* bk;
+    };
+    constexpr unsigned mallocBins = 128;
+    uint32_t largestFreeChunk(MallocChunk* const* av, unsigned bins = mallocBins);
+    uint32_t fragmentation(uint32_t largestFree, uint32_t free); // 100 * (1 - largestFree / free) in %
+
+    // binary reports ---------------------------------------------------------------
+    // Fixed 16 byte records without any formatting. Use decodeReport.py to print them on the host
+    // In the host simulation (bench_memoryTool.cpp) a record takes about 1% of the time and of the
+    // stack of a doPrintT4 report (~2.5kB, mostly printf buffers).
+
+    enum class Region : uint8_t {
+        unknown,
+        itcm,       // code copied to RAM-1
+        dataInit,   // initialized variables (DTCM on T4)
+        dataZeroed, // zeroed variables (DTCM on T4)
+        stack,
+        dmamem,     // RAM-2, not initialized
+        heap,
+        flash,
+        extmem,     // external PSRAM (T4.1)
+    };
+
+    constexpr const char* regionName(Region region) // same names as decodeReport.py
+    {
+        switch (region)
+        {
+            case Region::itcm: return "ITCM (Code copied to RAM-1)";
+            case Region::dataInit: return "DTCM (initialized, RAM-1)";
+            case Region::dataZeroed: return "DTCM (zeroed, RAM-1)";
+            case Region::stack: return "STACK (on RAM-1)";
+            case Region::dmamem: return "DMAMEM (not initialized, RAM-2)";
+            case Region::heap: return "HEAP (on RAM-2)";
+            case Region::flash: return "FLASH";
+            case Region::extmem: return "EXTMEM (PSRAM)";
+            default: return "unknown";
+        }
+    }
+
+    struct __attribute__((packed)) Record
+    {
+        uint16_t magic;    // recordMagic, used to sync the stream
+        uint8_t region;    // Region
+        uint8_t flags;     // bit 0: size not available (functions)
+        uint32_t nameHash; // FNV-1a hash of the name
+        uint32_t start;
+        uint32_t size;
+    };
+    static_assert(sizeof(Record) == 16, "unexpected record size");
+
+    constexpr uint16_t recordMagic = 0x544D; // 'M' 'T'
+
+    constexpr uint32_t nameHash(const char* s, uint32_t h = 2166136261u)
+    {
+        return *s ? nameHash(s + 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+    }
+
+    Region classify(const void* ptr);
+    size_t encode(const char* name, const void* start, uint32_t elemSize, uint32_t elements, uint8_t* buffer, size_t bufSize); // returns bytes written (0 if buffer too small)
+    void doWrite(const char* name, const void* start, uint32_t elemSize, uint32_t elements);                                   // writes a record to the stream
+
+    template <typename T>
+    void writeInfo(const char* name, T& var)
+    {
+        doWrite(name, (void*)&var, sizeof(T), 1);
+    }
+
+    template <size_t nrOfElements, typename T>
+    void writeInfo(const char* name, T (&var)[nrOfElements])
+    {
+        doWrite(name, &var, sizeof(T), nrOfElements);
+    }
+
+    template <typename F>
+    void writeFInfo(const char* name, F& f)
+    {
+        doWrite(name, (void*)&f, 0, 0);
+    }
+
+    // memory map (T4.x) ------------------------------------------------------------
+    // Constant table of the IMXRT1062 memory areas. Lookups are constexpr and only cost a few
+    // compares at runtime, i.e. they can be used in asserts of DMA setup code:
+    //   assert(MemoryTool::isDmaSafeRx(rxBuffer, sizeof(rxBuffer)));
+    // classify() and doPrintT4() look up the area here and only split DTCM and OCRAM further
+    // (variables, stack, heap) using the linker symbols.
+
+    constexpr uint32_t cacheLineSize = 32;
+
+    struct RegionInfo
+    {
+        uint32_t first, last; // address range, inclusive
+        const char* name;
+        bool cached;          // accessed through the write back data cache
+        bool dmaCapable;      // reachable by the eDMA
+        Region region;        // classification without the linker symbols
+    };
+
+    constexpr RegionInfo memoryMap[] = {
+#if defined(__IMXRT1062__)
+        {0x0000'0000, 0x0007'FFFF, "ITCM", false, false, Region::itcm},
+        {0x2000'0000, 0x2007'FFFF, "DTCM", false, true, Region::dataInit},  // variables and stack (RAM-1)
+        {0x2020'0000, 0x2027'FFFF, "OCRAM", true, true, Region::dmamem},    // DMAMEM and heap (RAM-2)
+        {0x6000'0000, 0x6FFF'FFFF, "FLASH", true, false, Region::flash},
+        {0x7000'0000, 0x7FFF'FFFF, "EXTMEM", true, true, Region::extmem}, // PSRAM (T4.1)
+#endif
+        {0x0000'0000, 0xFFFF'FFFF, "unknown", false, false, Region::unknown}, // catch all, needs to be the last entry
+    };
+
+    constexpr const RegionInfo& regionOf(uintptr_t address)
+    {
+        for (const RegionInfo& r : memoryMap)
+        {
+            if (address >= r.first && address <= r.last) return r;
+        }
+        return memoryMap[sizeof(memoryMap) / sizeof(memoryMap[0]) - 1];
+    }
+
+    constexpr bool isCached(uintptr_t address) { return regionOf(address).cached; }
+    constexpr bool isCacheAligned(uintptr_t address, size_t len) { return ((address | len) & (cacheLineSize - 1)) == 0; }
+
+    // Transmit buffers (read by the DMA) need to be completely inside a DMA capable region.
+    // Flushing the cache (prepareDmaTx) works for any alignment.
+    constexpr bool isDmaSafeTx(uintptr_t address, size_t len)
+    {
+        const RegionInfo& r = regionOf(address);
+        return r.dmaCapable && len != 0 && len - 1 <= r.last - address;
+    }
+
+    // Receive buffers in cached regions additionally need to start and end on cache line
+    // boundaries. Otherwise invalidating the buffer after a receive would also discard data
+    // of neighboring variables.
+    constexpr bool isDmaSafeRx(uintptr_t address, size_t len)
+    {
+        return isDmaSafeTx(address, len) && (!isCached(address) || isCacheAligned(address, len));
+    }
+
+    inline const RegionInfo& regionOf(const void* ptr) { return regionOf((uintptr_t)ptr); }
+    inline bool isCached(const void* ptr) { return isCached((uintptr_t)ptr); }
+    inline bool isCacheAligned(const void* ptr, size_t len) { return isCacheAligned((uintptr_t)ptr, len); }
+    inline bool isDmaSafeTx(const void* ptr, size_t len) { return isDmaSafeTx((uintptr_t)ptr, len); }
+    inline bool isDmaSafeRx(const void* ptr, size_t len) { return isDmaSafeRx((uintptr_t)ptr, len); }
+
+    // cache maintenance for DMA buffers, does nothing for uncached regions (DTCM)
+    inline void prepareDmaTx(const void* buf, size_t len) // before the DMA reads the buffer
+    {
+        if (isCached(buf)) arm_dcache_flush((void*)buf, len);
+    }
+
+    inline void prepareDmaRx(void* buf, size_t len) // before the DMA writes to the buffer, dirty lines must not be evicted into received data
+    {
+        if (isCached(buf)) arm_dcache_flush_delete(buf, len);
+    }
+
+    inline void completeDmaRx(void* buf, size_t len) // after the transfer, drops lines which were speculatively loaded in between
+    {
+        if (isCached(buf)) arm_dcache_delete(buf, len);
+    }
+
+    // allocation tracker -----------------------------------------------------------
+    // Counts heap allocations per call site (return address of the caller of new/malloc).
+    //
+    // Opt in: uncomment USE_ALLOCATION_TRACKER below. This replaces the global operator new/delete.
+    // To also track plain malloc/free/calloc/realloc calls add
+    //   -Wl,--wrap=malloc,--wrap=free,--wrap=calloc,--wrap=realloc
+    // to the linker flags (e.g. compiler.c.elf.extra_flags in platform.local.txt) and uncomment
+    // USE_ALLOCATION_TRACKER_MALLOC as well.
+    // Each tracked block carries an 8 byte header with its size and call site. Blocks allocated
+    // by newlib internally (_malloc_r) are not tracked. A failing new calls the new_handler, then
+    // throws std::bad_alloc (aborts if exceptions are disabled). realloc keeps the call site of
+    // the block and resizes it in place where possible.
+    //
+    // Resolve the printed call sites with addr2line -e sketch.elf 0x...
+
+    //#define USE_ALLOCATION_TRACKER
+    //#define USE_ALLOCATION_TRACKER_MALLOC
+    #define ALLOCATION_SITES 64 // size of the call site table, needs to be a power of 2
+
+    struct AllocationSite
+    {
+        uint32_t caller;     // return address of the allocating call
+        uint32_t allocs;     // number of allocations
+        uint32_t frees;      // number of freed blocks
+        uint32_t totalBytes; // sum of all allocated bytes
+        uint32_t liveBytes;  // currently allocated
+        uint32_t peakBytes;  // max of liveBytes
+    };
+
+    struct AllocationStats
+    {
+        uint32_t allocs;
+        uint32_t frees;
+        uint32_t liveBytes;
+        uint32_t peakBytes;
+        uint32_t sites;         // used entries of the call site table
+        uint32_t untracked;     // allocations which didn't find a free entry in the table
+        uint32_t forbidden;     // allocations inside a NoAllocScope or an interrupt handler
+        uint32_t lastForbidden; // caller of the last forbidden allocation
+    };
+
+    AllocationStats getAllocationStats();
+    unsigned getAllocationSites(AllocationSite* sites, unsigned maxSites); // copies the table, returns number of sites
+    void printAllocationSites();                                          // sorted by live bytes
+    void resetAllocationStats();                                          // keeps the live bytes of still allocated blocks
+
+    // Allocations while a NoAllocScope is active, or from an interrupt handler, are counted as
+    // forbidden. With setAllocationTrap(true) they stop the program (breakpoint / hard fault)
+    // which shows the offending call in the debugger or the crash report.
+    void setAllocationTrap(bool trap);
+
+    class NoAllocScope
+    {
+     public:
+        NoAllocScope();
+        ~NoAllocScope();
+
+        NoAllocScope(const NoAllocScope&)            = delete;
+        NoAllocScope& operator=(const NoAllocScope&) = delete;
+    };
 }
 
 // helpers to automatically extract variable name
@@ -41,3 +290,6 @@ namespace MemoryTool
 
 #define printMemoryInfo(var) MemoryTool::printInfo(#var, (var))
 #define printFuncInfo(f) MemoryTool::printFInfo(#f, (f))
+
+#define writeMemoryInfo(var) MemoryTool::writeInfo(#var, (var))
+#define writeFuncInfo(f) MemoryTool::writeFInfo(#f, (f))
@@ -0,0 +1,144 @@
+#include "regionAllocator.h"
+#include "Stream.h"
+#include <cstdlib>
+#include <new>
+
+namespace MemoryTool
+{
+    namespace // private -----------------------------
+    {
+        constexpr size_t minBlockAlign = alignof(max_align_t);
+
+        inline uintptr_t alignUp(uintptr_t p, size_t align)
+        {
+            return (p + align - 1) & ~(uintptr_t)(align - 1);
+        }
+
+        void reportAndHalt(const RegionResource& r, size_t bytes)
+        {
+            getStream().printf("%s: allocation of %u bytes failed (%s, %u of %u bytes used)\n", r.name(), (unsigned)bytes,
+                               regionName(r.region()), (unsigned)r.used(), (unsigned)r.size());
+            getStream().flush();
+            abort();
+        }
+
+        void reportInvalidFreeAndHalt(const RegionResource& r, const void* p)
+        {
+            getStream().printf("%s: deallocate(0x%08lX) doesn't point to a block of the pool\n", r.name(), (unsigned long)(uintptr_t)p);
+            getStream().flush();
+            abort();
+        }
+
+        RegionFailureHandler failureHandler         = reportAndHalt;
+        RegionInvalidFreeHandler invalidFreeHandler = reportInvalidFreeAndHalt;
+    } // end private namespace <<---------------------
+
+    //-------------------------------------------------------------------------------
+    // Arena
+
+    Arena::Arena(void* buffer, size_t size, const char* name)
+        : RegionResource(name, (uint8_t*)buffer, size)
+    {
+    }
+
+    void* Arena::allocate(size_t bytes, size_t align)
+    {
+        uintptr_t p   = alignUp((uintptr_t)start + used_, align);
+        size_t offset = p - (uintptr_t)start;
+
+        if (offset > size_ || bytes > size_ - offset)
+        {
+            failures_++;
+            return nullptr;
+        }
+        setUsed(offset + bytes);
+        return (void*)p;
+    }
+
+    void Arena::deallocate(void* p, size_t bytes)
+    {
+        if ((uint8_t*)p + bytes == start + used_) used_ = (uint8_t*)p - start;
+    }
+
+    void Arena::reset()
+    {
+        used_ = 0;
+    }
+
+    //-------------------------------------------------------------------------------
+    // Pool
+
+    Pool::Pool(void* buffer, size_t size, size_t blockSize, const char* name)
+        : RegionResource(name, (uint8_t*)alignUp((uintptr_t)buffer, minBlockAlign), 0)
+    {
+        size_t skipped = start - (uint8_t*)buffer;
+        blockSize_     = alignUp(blockSize < sizeof(void*) ? sizeof(void*) : blockSize, minBlockAlign);
+        size_          = size > skipped ? ((size - skipped) / blockSize_) * blockSize_ : 0;
+
+        for (uint8_t* block = start + size_; block > start;) // chain the blocks, lowest address first
+        {
+            block -= blockSize_;
+            *(void**)block = freeList;
+            freeList       = block;
+        }
+    }
+
+    void* Pool::allocate(size_t bytes, size_t align)
+    {
+        if (bytes > blockSize_ || align > minBlockAlign || freeList == nullptr)
+        {
+            failures_++;
+            return nullptr;
+        }
+        void* block = freeList;
+        freeList    = *(void**)block;
+        setUsed(used_ + blockSize_);
+        return block;
+    }
+
+    void Pool::deallocate(void* p, size_t)
+    {
+        if (p == nullptr) return;
+        if (!owns(p) || ((uint8_t*)p - start) % blockSize_ != 0) // chaining it would corrupt the free list
+        {
+            invalidFreeHandler(*this, p);
+            return;
+        }
+        *(void**)p = freeList;
+        freeList   = p;
+        used_ -= blockSize_;
+    }
+
+    //-------------------------------------------------------------------------------
+
+    void setRegionFailureHandler(RegionFailureHandler handler)
+    {
+        failureHandler = handler != nullptr ? handler : reportAndHalt;
+    }
+
+    void setRegionInvalidFreeHandler(RegionInvalidFreeHandler handler)
+    {
+        invalidFreeHandler = handler != nullptr ? handler : reportInvalidFreeAndHalt;
+    }
+
+    void regionAllocationFailed(const RegionResource& resource, size_t bytes)
+    {
+        failureHandler(resource, bytes);
+#if defined(__cpp_exceptions) // the handler returned
+        throw std::bad_alloc();
+#else
+        abort();
+#endif
+    }
+
+    void printAllocators()
+    {
+        Stream* s = &getStream();
+        s->printf("name               size       used       peak   failures  region\n");
+        for (RegionResource* r = static_cast<RegionResource*>(RegionResource::first); r != nullptr; r = static_cast<RegionResource*>(r->next))
+        {
+            s->printf("%-12s %10u %10u %10u %10lu  %s\n", r->name(), (unsigned)r->size(), (unsigned)r->used(),
+                      (unsigned)r->peak(), r->failures(), regionName(r->region()));
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+/************************************************************************************
+ * Bump arenas and fixed block pools on user supplied buffers
+ *
+ * The memory region is determined by the buffer, i.e. by the usual Teensy attributes:
+ *
+ *   uint8_t fastMem[8 * 1024];            // DTCM (RAM-1), single cycle access
+ *   DMAMEM uint8_t bulkMem[64 * 1024];    // OCRAM (RAM-2), cached, not initialized
+ *   EXTMEM uint8_t psram[1024 * 1024];    // PSRAM (T4.1 only)
+ *
+ *   MemoryTool::Arena fast(fastMem, "fast");
+ *   MemoryTool::Pool nodes(bulkMem, 32, "nodes"); // 32 byte blocks
+ *
+ *   std::vector<int, MemoryTool::RegionAllocator<int, MemoryTool::Arena>> v(fast);
+ *   std::list<float, MemoryTool::RegionAllocator<float, MemoryTool::Pool>> l(nodes);
+ *
+ * Arena: allocates by incrementing a pointer. deallocate() only releases the most
+ *        recent allocation, reset() releases everything.
+ * Pool:  blocks of a fixed size, allocation and deallocation are O(1). Requests larger
+ *        than the block size fail. Good fit for node based containers (list, map...).
+ *
+ * Allocators never fall back to the heap. Arena/Pool::allocate() return nullptr if they
+ * are exhausted, the failure is counted. RegionAllocator (used by the std containers)
+ * must not return nullptr, it calls the failure handler instead. The default handler
+ * prints the resource and halts, setRegionFailureHandler() installs your own one (e.g.
+ * to log and reset, or to throw). If it returns, std::bad_alloc is thrown (abort()
+ * without exceptions). Use printAllocators() to check size, peak usage and failures of
+ * all arenas and pools. Arenas and pools are not interrupt safe.
+ *
+ * Pool::deallocate() checks that the pointer is the start of a block of the pool. Other
+ * pointers (foreign memory, pointers into a block) are passed to the invalid free handler
+ * and not freed. The default handler prints the resource and the pointer and halts,
+ * setRegionInvalidFreeHandler() installs your own one. Double frees are not detected.
+ ************************************************************************************/
+
+#include "instanceList.h"
+#include "memoryTool.h"
+
+namespace MemoryTool
+{
+    // common bookkeeping of arenas and pools
+    class RegionResource : protected InstanceList<RegionResource>
+    {
+     public:
+        const char* name() const { return name_; }
+        Region region() const { return classify(start); }
+        size_t size() const { return size_; }
+        size_t used() const { return used_; }
+        size_t peak() const { return peak_; }
+        uint32_t failures() const { return failures_; }
+        bool owns(const void* p) const { return p >= start && p < start + size_; }
+
+        RegionResource(const RegionResource&)            = delete; // containers refer to the resource, a copy would hand out the same memory
+        RegionResource& operator=(const RegionResource&) = delete;
+
+     protected:
+        RegionResource(const char* name, uint8_t* buffer, size_t size)
+            : name_(name), start(buffer), size_(size) {}
+
+        void setUsed(size_t bytes)
+        {
+            used_ = bytes;
+            if (used_ > peak_) peak_ = used_;
+        }
+
+        const char* name_;
+        uint8_t* start;
+        size_t size_;
+        size_t used_ = 0, peak_ = 0;
+        uint32_t failures_ = 0;
+
+        friend void printAllocators();
+    };
+
+    class Arena : public RegionResource
+    {
+     public:
+        Arena(void* buffer, size_t size, const char* name = "arena");
+
+        template <size_t N>
+        Arena(uint8_t (&buffer)[N], const char* name = "arena")
+            : Arena(buffer, N, name) {}
+
+        void* allocate(size_t bytes, size_t align = alignof(max_align_t)); // nullptr if exhausted
+        void deallocate(void* p, size_t bytes);                            // only releases the last allocation
+        void reset();
+    };
+
+    class Pool : public RegionResource
+    {
+     public:
+        Pool(void* buffer, size_t size, size_t blockSize, const char* name = "pool");
+
+        template <size_t N>
+        Pool(uint8_t (&buffer)[N], size_t blockSize, const char* name = "pool")
+            : Pool(buffer, N, blockSize, name) {}
+
+        void* allocate(size_t bytes, size_t align = alignof(max_align_t)); // nullptr if exhausted or bytes > blockSize
+        void deallocate(void* p, size_t bytes = 0);                        // p must be a block of this pool (or nullptr)
+
+        size_t blockSize() const { return blockSize_; }
+        size_t blocks() const { return size_ / blockSize_; }
+
+     private:
+        void* freeList = nullptr; // free blocks are chained through their first word
+        size_t blockSize_;
+    };
+
+    using RegionFailureHandler = void (*)(const RegionResource& resource, size_t bytes);
+    void setRegionFailureHandler(RegionFailureHandler handler); // nullptr: default handler, prints and halts
+    [[noreturn]] void regionAllocationFailed(const RegionResource& resource, size_t bytes);
+
+    using RegionInvalidFreeHandler = void (*)(const RegionResource& resource, const void* p);
+    void setRegionInvalidFreeHandler(RegionInvalidFreeHandler handler); // nullptr: default handler, prints and halts
+
+    // std allocator on top of an Arena or a Pool. Copies share the resource
+    template <typename T, class Resource>
+    class RegionAllocator
+    {
+     public:
+        using value_type = T;
+
+        RegionAllocator(Resource& r) : resource(&r) {}
+
+        template <typename U>
+        RegionAllocator(const RegionAllocator<U, Resource>& other) : resource(other.resource) {}
+
+        T* allocate(size_t n)
+        {
+            void* p = n <= SIZE_MAX / sizeof(T) ? resource->allocate(n * sizeof(T), alignof(T)) : nullptr;
+            if (p == nullptr) regionAllocationFailed(*resource, n * sizeof(T));
+            return (T*)p;
+        }
+        void deallocate(T* p, size_t n) { resource->deallocate(p, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const RegionAllocator<U, Resource>& other) const { return resource == other.resource; }
+        template <typename U>
+        bool operator!=(const RegionAllocator<U, Resource>& other) const { return resource != other.resource; }
+
+        Resource* resource;
+    };
+
+    void printAllocators(); // name, region, usage, peak and failures of all arenas and pools
+}
@@ -0,0 +1,205 @@
+#include "pcSampler.h"
+
+#if defined(__IMXRT1062__) && defined(__arm__) // reads the exception frame, T4.x only
+
+#include "IntervalTimerEx.h"
+
+extern "C" {
+// shared with the trampoline
+volatile uint32_t pcSampler_lastPC = 0xFFFF'FFFF;
+void (*pcSampler_pitHandler)()     = nullptr;
+void pcSampler_account(uint32_t entryCycles);
+
+// code regions (linker symbols)
+extern unsigned long _stext;
+extern unsigned long _etext;
+extern unsigned long _flashimagelen;
+}
+
+namespace PcSampler
+{
+    namespace // private
+    {
+        static_assert((PC_SAMPLER_SLOTS & (PC_SAMPLER_SLOTS - 1)) == 0, "PC_SAMPLER_SLOTS needs to be a power of 2");
+
+        constexpr uint32_t noPC     = 0xFFFF'FFFF; // PCs are halfword aligned, i.e. never odd
+        constexpr unsigned maxProbe = 16;          // bounds the time spent in the interrupt when the table fills up
+
+        uint32_t pcs[PC_SAMPLER_SLOTS];
+        uint32_t counts[PC_SAMPLER_SLOTS];
+
+        IntervalTimerEx timer;
+        uint32_t samples   = 0;
+        uint32_t dropped   = 0;
+        uint32_t missed    = 0;
+        uint32_t maxCycles = 0;
+        uint64_t sumCycles = 0;
+        volatile bool sampled = false;             // set by sample(), tells pcSampler_account that the interrupt was ours
+
+        // Placed in front of the core PIT isr. Stores the stacked PC of the interrupted context,
+        // calls the original handler and accounts the cycles spent in the handler.
+        __attribute__((naked)) void trampoline()
+        {
+            asm volatile(
+                "ldr r12, =0xE0001004        \n" // ARM_DWT_CYCCNT
+                "ldr r12, [r12]              \n"
+                "tst lr, #4                  \n" // which stack was used by the interrupted context?
+                "ite eq                      \n"
+                "mrseq r0, msp               \n"
+                "mrsne r0, psp               \n"
+                "ldr r0, [r0, #24]           \n" // stacked PC
+                "ldr r1, =pcSampler_lastPC   \n"
+                "str r0, [r1]                \n"
+                "push {r4, lr}               \n" // lr holds EXC_RETURN
+                "mov r4, r12                 \n"
+                "ldr r1, =pcSampler_pitHandler\n"
+                "ldr r1, [r1]                \n"
+                "blx r1                      \n"
+                "mov r0, r4                  \n"
+                "bl pcSampler_account        \n"
+                "pop {r4, pc}                \n"); // exception return
+        }
+
+        struct CodeRegion
+        {
+            const char* name;
+            uint32_t start, end; // [start, end)
+        };
+
+        // ITCM: code copied to RAM-1 (FASTRUN, default for functions), FLASH: FLASHMEM / PROGMEM code
+        void codeRegions(CodeRegion (&regions)[2])
+        {
+            regions[0] = {"ITCM", (uint32_t)&_stext, (uint32_t)&_etext};
+            regions[1] = {"FLASH", 0x6000'0000, 0x6000'0000 + (uint32_t)&_flashimagelen};
+        }
+
+        const char* regionOf(const CodeRegion (&regions)[2], uint32_t pc)
+        {
+            for (const CodeRegion& r : regions)
+            {
+                if (pc >= r.start && pc < r.end) return r.name;
+            }
+            return "OTHER"; // e.g. boot ROM or code in other RAM
+        }
+
+        void count(uint32_t pc)
+        {
+            uint32_t slot = ((pc >> 1) * 2654435761u) >> (32 - __builtin_ctz(PC_SAMPLER_SLOTS)); // Fibonacci hashing
+            for (unsigned i = 0; i < maxProbe; i++, slot = (slot + 1) & (PC_SAMPLER_SLOTS - 1))
+            {
+                if (pcs[slot] == pc)
+                {
+                    counts[slot]++;
+                    return;
+                }
+                if (pcs[slot] == noPC)
+                {
+                    pcs[slot]    = pc;
+                    counts[slot] = 1;
+                    return;
+                }
+            }
+            dropped++;
+        }
+
+        void sample()
+        {
+            uint32_t pc      = pcSampler_lastPC;
+            pcSampler_lastPC = noPC;
+
+            if (pc == noPC) // the core re-attached its handler (IntervalTimer::begin), put the trampoline back in front
+            {
+                missed++;
+                if (_VectorsRam[IRQ_PIT + 16] != trampoline)
+                {
+                    pcSampler_pitHandler = _VectorsRam[IRQ_PIT + 16];
+                    _VectorsRam[IRQ_PIT + 16] = trampoline;
+                }
+                return;
+            }
+            count(pc);
+            samples++;
+            sampled = true;
+        }
+    }
+
+    bool begin(uint32_t rate)
+    {
+        reset();
+
+#if defined(USE_CPP11_CALLBACKS)
+        if (!timer.begin(sample, 1'000'000.0f / rate)) return false;
+#else
+        if (!timer.begin([](void*) { sample(); }, nullptr, 1'000'000.0f / rate)) return false;
+#endif
+
+        noInterrupts();
+        if (_VectorsRam[IRQ_PIT + 16] != trampoline)
+        {
+            pcSampler_pitHandler = _VectorsRam[IRQ_PIT + 16];
+            attachInterruptVector(IRQ_PIT, trampoline);
+        }
+        interrupts();
+        return true;
+    }
+
+    void end()
+    {
+        timer.end();
+
+        noInterrupts();
+        if (_VectorsRam[IRQ_PIT + 16] == trampoline) attachInterruptVector(IRQ_PIT, pcSampler_pitHandler);
+        interrupts();
+    }
+
+    void reset()
+    {
+        noInterrupts();
+        for (uint32_t& pc : pcs) pc = noPC;
+        for (uint32_t& c : counts) c = 0;
+        samples = dropped = missed = maxCycles = 0;
+        sumCycles = 0;
+        interrupts();
+    }
+
+    Stats getStats()
+    {
+        noInterrupts();
+        Stats s{samples, dropped, missed, maxCycles, samples ? (uint32_t)(sumCycles / samples) : 0};
+        interrupts();
+        return s;
+    }
+
+    void dump(Stream& stream)
+    {
+        CodeRegion regions[2];
+        codeRegions(regions); // the samples are classified here, not in the interrupt
+
+        Stats s = getStats();
+        stream.printf("# samples %lu dropped %lu missed %lu cycles/sample max %lu mean %lu\n", s.samples, s.dropped, s.missed, s.maxCycles, s.meanCycles);
+        for (const CodeRegion& r : regions)
+        {
+            stream.printf("# region %s 0x%08lX 0x%08lX\n", r.name, r.start, r.end);
+        }
+        for (unsigned i = 0; i < PC_SAMPLER_SLOTS; i++)
+        {
+            if (pcs[i] == noPC) continue;
+            stream.printf("0x%08lX %lu %s\n", pcs[i], counts[i], regionOf(regions, pcs[i]));
+        }
+    }
+}
+
+// called by the trampoline after the PIT handler returned
+void pcSampler_account(uint32_t entryCycles)
+{
+    using namespace PcSampler;
+    pcSampler_lastPC = noPC;
+    if (!sampled) return; // PIT interrupt of another timer
+    sampled = false;
+
+    uint32_t dt = ARM_DWT_CYCCNT - entryCycles + PC_SAMPLER_EXCEPTION_CYCLES;
+    sumCycles += dt;
+    if (dt > maxCycles) maxCycles = dt;
+}
+
+#endif
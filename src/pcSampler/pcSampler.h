@@ -0,0 +1,48 @@
+#pragma once
+/************************************************************************************
+ * Statistical PC sampling profiler (T4.x)
+ *
+ * An IntervalTimerEx periodically interrupts the running code. A small trampoline in
+ * front of the PIT interrupt reads the program counter of the interrupted context from
+ * the exception stack frame, the timer callback counts it in a hash table with one slot
+ * per distinct address. The addresses are resolved to functions on the host
+ * (pcSymbols.py), i.e. there are no address buckets which could span two functions.
+ *
+ * begin(rate):     starts sampling with the given rate in Hz
+ * end():           stops sampling
+ * dump(stream):    prints the sampled addresses as "address count region" lines
+ *                  (region: ITCM, FLASH or OTHER), use pcSymbols.py on the host to
+ *                  map them to function names and to sum them up per region
+ * getStats():      number of samples and the cycles spent per sample
+ *
+ * The cycles per sample cover the whole PIT interrupt: exception entry and exit
+ * (estimated, PC_SAMPLER_EXCEPTION_CYCLES), the core PIT handler, the IntervalTimerEx
+ * relay and callback and the counting.
+ *
+ * The core re-attaches its PIT handler whenever an IntervalTimer is started. The
+ * sampler notices this at its next interrupt and re-installs the trampoline, the
+ * sample of this interrupt is lost (Stats::missed).
+ ************************************************************************************/
+
+#include "Arduino.h"
+
+#define PC_SAMPLER_SLOTS 1024           // distinct addresses, power of 2. Needs 8 bytes per slot
+#define PC_SAMPLER_EXCEPTION_CYCLES 24  // exception entry + exit (stacking, unstacking), can't be measured in software
+
+namespace PcSampler
+{
+    struct Stats
+    {
+        uint32_t samples;    // total number of samples
+        uint32_t dropped;    // samples not counted since the address table was full
+        uint32_t missed;     // interrupts which bypassed the trampoline (IntervalTimer started after begin)
+        uint32_t maxCycles;  // longest PIT interrupt with a sample
+        uint32_t meanCycles; // mean cycles of the PIT interrupts with a sample
+    };
+
+    bool begin(uint32_t rate = 10'000);
+    void end();
+    void reset();
+    Stats getStats();
+    void dump(Stream& stream = Serial);
+}
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""
+Maps a PcSampler::dump() output to function names and prints the totals per code
+region (ITCM, FLASH, OTHER).
+
+usage: pcSymbols.py firmware.elf dump.txt [nm]
+
+The elf file is usually found in the build folder of your sketch. 'nm' defaults
+to arm-none-eabi-nm which needs to be on the path.
+"""
+import bisect
+import subprocess
+import sys
+from collections import Counter
+
+
+def read_symbols(elf, nm):
+    out = subprocess.run([nm, "-n", "-C", "--defined-only", elf], capture_output=True, text=True, check=True).stdout
+    addrs, names = [], []
+    for line in out.splitlines():
+        parts = line.split(maxsplit=2)
+        if len(parts) == 3 and parts[1] in "tTwW":
+            addrs.append(int(parts[0], 16) & ~1)
+            names.append(parts[2])
+    return addrs, names
+
+
+def summarize(lines, addrs, names):
+    """sums the dump lines ("address count region") up per function and per code region"""
+    perSymbol, perRegion = Counter(), Counter()
+    for line in lines:
+        if line.startswith("#"):
+            print(line.rstrip())
+            continue
+        parts = line.split()
+        if len(parts) not in (2, 3):
+            continue
+        addr, count = int(parts[0], 16), int(parts[1])
+        i = bisect.bisect_right(addrs, addr) - 1
+        perSymbol[names[i] if i >= 0 else "???"] += count
+        perRegion[parts[2] if len(parts) == 3 else "?"] += count
+    return perSymbol, perRegion
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+
+    addrs, names = read_symbols(sys.argv[1], sys.argv[3] if len(sys.argv) > 3 else "arm-none-eabi-nm")
+
+    with open(sys.argv[2]) as f:
+        perSymbol, perRegion = summarize(f, addrs, names)
+
+    total = sum(perSymbol.values())
+    if total == 0:
+        return
+    for name, count in perSymbol.most_common():
+        print(f"{100.0 * count / total:6.2f}% {count:8d}  {name}")
+    print()
+    for region, count in perRegion.most_common():
+        print(f"{100.0 * count / total:6.2f}% {count:8d}  [{region}]")
+
+
+if __name__ == "__main__":
+    main()
@@ -10,3 +10,131 @@ inline void pinMode(std::initializer_list<uint8_t> pins, uint8_t mode)
         pinMode(pin, mode);
     }
 }
+
+#if defined(__IMXRT1062__)
+
+#include "ParallelBus.h" // pin table
+#include <cstdlib>
+
+namespace PinGroupDetail
+{
+    // Not constexpr on purpose: reaching one of them while a constexpr PinGroup is evaluated
+    // makes the definition a compile error which names the problem. Groups built at runtime stop.
+    inline void error_pin_without_fast_GPIO() { abort(); }
+    inline void error_duplicate_pin() { abort(); }
+    inline void error_more_than_32_pins() { abort(); }
+}
+
+/**
+ * PinGroup combines an arbitrary list of pins (T4.x)
+ * Port masks are precomputed (at compile time for constexpr groups), setting, clearing,
+ * toggling and reading the group needs one register access per involved GPIO port.
+ * Pins on the same port change simultaneously.
+ *
+ * constexpr PinGroup leds{2, 3, 4, 5};
+ *
+ * Invalid pins, duplicates or more than 32 pins don't compile for constexpr groups (the error
+ * message names PinGroupDetail::error_xx), groups constructed at runtime call abort().
+ */
+class PinGroup
+{
+ public:
+    constexpr PinGroup(std::initializer_list<uint8_t> list)
+    {
+        for (uint8_t pin : list)
+        {
+            auto info = ParallelBusDetail::pinInfo(pin);
+            if (info.port == 0) PinGroupDetail::error_pin_without_fast_GPIO();
+            if (count >= 32) PinGroupDetail::error_more_than_32_pins();
+            if (masks[info.port - 6] & (1UL << info.bit)) PinGroupDetail::error_duplicate_pin(); // would shift the bits of all following pins
+
+            pins[count]  = pin;
+            bits[count]  = info.bit;
+            ports[count] = info.port - 6;
+            masks[info.port - 6] |= 1UL << info.bit;
+            count++;
+        }
+    }
+
+    void pinMode(uint8_t mode) const // configures pad and mux per pin
+    {
+        for (unsigned i = 0; i < count; i++) ::pinMode(pins[i], mode);
+    }
+
+    void setDirection(bool output) const // GDIR, one access per port
+    {
+        for (unsigned p = 0; p < 4; p++)
+        {
+            if (masks[p] == 0) continue;
+            if (output)
+                reg(p, GDIR) |= masks[p];
+            else
+                reg(p, GDIR) &= ~masks[p];
+        }
+    }
+
+    void set() const { writeAll(DR_SET); }
+    void clear() const { writeAll(DR_CLEAR); }
+    void toggle() const { writeAll(DR_TOGGLE); }
+
+    void write(uint32_t value) const // bit i of value -> i-th pin of the group
+    {
+        uint32_t desired[4]{};
+        for (unsigned i = 0; i < count; i++)
+        {
+            if (value & (1UL << i)) desired[ports[i]] |= 1UL << bits[i];
+        }
+        for (unsigned p = 0; p < 4; p++)
+        {
+            if (masks[p] == 0) continue;
+            reg(p, DR_TOGGLE) = (reg(p, DR) ^ desired[p]) & masks[p];
+        }
+    }
+
+    uint32_t read() const // i-th pin of the group -> bit i of the result
+    {
+        uint32_t psr[4]{};
+        for (unsigned p = 0; p < 4; p++)
+        {
+            if (masks[p] != 0) psr[p] = reg(p, PSR);
+        }
+
+        uint32_t result = 0;
+        for (unsigned i = 0; i < count; i++)
+        {
+            result |= ((psr[ports[i]] >> bits[i]) & 1) << i;
+        }
+        return result;
+    }
+
+    constexpr uint32_t portMask(unsigned gpio) const { return masks[gpio - 6]; } // mask for GPIO6..9
+    constexpr unsigned size() const { return count; }
+
+ protected:
+    enum offset : uintptr_t { DR = 0x00, GDIR = 0x04, PSR = 0x08, DR_SET = 0x84, DR_CLEAR = 0x88, DR_TOGGLE = 0x8C };
+
+    static volatile uint32_t& reg(unsigned port, offset off) // GPIO6 ... GPIO9
+    {
+#if defined(ARDUINO_TEENSY_SIM)
+        return *sim::gpioReg(port + 6, off / sizeof(uint32_t));
+#else
+        return *(volatile uint32_t*)(0x4200'0000 + port * 0x4000 + off);
+#endif
+    }
+
+    void writeAll(offset off) const
+    {
+        for (unsigned p = 0; p < 4; p++)
+        {
+            if (masks[p] != 0) reg(p, off) = masks[p];
+        }
+    }
+
+    uint32_t masks[4]{}; // GPIO6 ... GPIO9
+    uint8_t pins[32]{};
+    uint8_t bits[32]{};
+    uint8_t ports[32]{};
+    unsigned count = 0;
+};
+
+#endif
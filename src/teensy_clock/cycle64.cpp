@@ -2,24 +2,67 @@
 
 #include "Arduino.h"
 
+//#define CYCLES64_USE_NOINTERRUPTS  // uncomment to use the original read path which disables interrupts during get()
+
+#if !defined(__arm__) && !defined(ARDUINO_TEENSY_SIM) && !defined(CYCLES64_USE_NOINTERRUPTS)
+    #define CYCLES64_USE_NOINTERRUPTS // no LDREX/STREX off target (the host simulation emulates them)
+#endif
+
 namespace cycles64
 {
     uint64_t get();
 
     namespace // private -----------------------------
     {
+        void (*secondTick)(uint64_t) = nullptr;
+
+#if defined(CYCLES64_USE_NOINTERRUPTS)
         uint32_t oldLow = ARM_DWT_CYCCNT;
         uint32_t curHigh = 0;
+#else
+        // Number of half overflow periods (2^31 cycles) since start. Its lowest bit always
+        // corresponds to the MSB of the cycle counter at the last update. Since all state fits into one
+        // word it can be updated with LDREX/STREX without disabling interrupts
+        volatile uint32_t epoch = ARM_DWT_CYCCNT >> 31;
+
+    #if defined(__arm__)
+        inline uint32_t ldrex(volatile uint32_t* addr)
+        {
+            uint32_t result;
+            asm volatile("ldrex %0, [%1]" : "=r"(result) : "r"(addr) : "memory");
+            return result;
+        }
+
+        inline uint32_t strex(uint32_t value, volatile uint32_t* addr) // returns 0 on success
+        {
+            uint32_t result;
+            asm volatile("strex %0, %2, [%1]" : "=&r"(result) : "r"(addr), "r"(value) : "memory");
+            return result;
+        }
+
+        inline void clrex()
+        {
+            asm volatile("clrex" ::: "memory");
+        }
+    #else
+        using sim::ldrex, sim::strex, sim::clrex; // emulated exclusive monitor
+    #endif
+#endif
 
         void SNVS_isr(void)
         {
-            SNVS_HPSR |= 0b11; // reset interrupt flag
-            get();             // call to check for overflow
-            asm("dsb");        // prevent double calls of the isr
+            SNVS_HPSR |= 0b11;            // reset interrupt flag
+            uint64_t cycles = get();      // call to check for overflow
+            if (secondTick) secondTick(cycles);
+#if defined(__arm__)
+            asm("dsb");                   // prevent double calls of the isr
+#endif
         }
 
     } // end private namespace <<---------------------
 
+#if defined(CYCLES64_USE_NOINTERRUPTS)
+
     uint64_t get()
     {
         noInterrupts();
@@ -36,6 +79,33 @@ namespace cycles64
         
     }
 
+#else
+
+    uint64_t get()
+    {
+        uint32_t e, curLow;
+        while (true)
+        {
+            e      = ldrex(&epoch);
+            curLow = ARM_DWT_CYCCNT;
+            if ((e & 1) == (curLow >> 31)) // still in the same half period, nothing to update
+            {
+                clrex();
+                break;
+            }
+            e++;                            // MSB of the counter toggled -> next half period
+            if (strex(e, &epoch) == 0) break; // an interrupt in between clears the exclusive monitor -> retry
+        }
+        return ((uint64_t)(e >> 1) << 32) | curLow;  // e = 2*high + msb(curLow)
+    }
+
+#endif
+
+    void attachSecondTick(void (*callback)(uint64_t cycles))
+    {
+        secondTick = callback;
+    }
+
     void begin()
     {
         // disable periodic snvs interrupt
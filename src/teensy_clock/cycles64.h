@@ -1,12 +1,21 @@
 #pragma once
 /************************************************************************************
  * Implements a 64bit extension of the cycle counter (ARM_DWT_CYCCNT). The extension
- * only works if get() is called at least once per overflow period (~7s @600MHz).
+ * only works if get() is called at least once per half overflow period (~3.5s @600MHz).
  * Thus, the code sets up the periodic interrupt of the SNVS module (Real Time Clock)
  * to call get once per second automaticall.
  *
+ * get() doesn't disable interrupts. The extension state is a single word which is
+ * updated with LDREX/STREX, so get() can safely be called from any ISR priority.
+ * The price is a shorter guarantee: the state tracks half overflow periods, i.e.
+ * get() needs to be called at least every 2^31 cycles (3.5s @600MHz) instead of
+ * every 2^32 cycles (7.1s) with CYCLES64_USE_NOINTERRUPTS. The 1Hz RTC interrupt
+ * covers both as long as it isn't blocked for more than ~2.5s.
+ *
  * begin():  sets up the periodic RTC interrupt to update the counter
  * get():    returns the 64bit cycle counter
+ * attachSecondTick(cb): cb is called with the current counter value at each
+ *           RTC second edge (from the SNVS interrupt)
  *
  * luni64 10-2020, Licence: MIT
  ************************************************************************************/
@@ -17,4 +26,5 @@ namespace cycles64
 {
     extern void begin();
     extern uint64_t get();
+    extern void attachSecondTick(void (*callback)(uint64_t cycles));
 }
\ No newline at end of file
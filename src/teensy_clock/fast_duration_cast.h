@@ -0,0 +1,157 @@
+#pragma once
+/************************************************************************************
+ * Division free std::chrono conversions for teensy_clock durations.
+ *
+ * Converting cycles (1/F_CPU) to µs, ns or seconds requires a 64bit division which the
+ * Cortex-M7 does in a slow software routine. Since F_CPU and the target unit are known
+ * at compile time, the division by the constant denominator can be replaced by a
+ * multiplication with a precomputed 64bit reciprocal and a shift (Granlund/Montgomery
+ * round-up method, as used by libdivide). The reciprocals are computed by constexpr
+ * functions, no runtime setup required.
+ *
+ * The result is exact, i.e. identical to floor(count * num / den) for all inputs,
+ * including those where std::chrono::duration_cast would overflow in count * num.
+ *
+ * fast_duration_cast<To>(d):    drop in replacement for std::chrono::duration_cast
+ * fast_time_point_cast<To>(tp): drop in replacement for std::chrono::time_point_cast
+ *
+ * Non unsigned source representations are passed on to std::chrono::duration_cast.
+ ************************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+
+namespace fast_chrono
+{
+    namespace detail
+    {
+        // high 64 bits of the 128 bit product a*b (compiles to UMULL/UMLAL on ARM)
+        constexpr uint64_t mulhi(uint64_t a, uint64_t b)
+        {
+            uint64_t aL = (uint32_t)a, aH = a >> 32;
+            uint64_t bL = (uint32_t)b, bH = b >> 32;
+
+            uint64_t ll = aL * bL, lh = aL * bH, hl = aH * bL, hh = aH * bH;
+            uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+            return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        }
+
+        constexpr unsigned floorLog2(uint64_t d)
+        {
+            unsigned r = 0;
+            while (d >>= 1) r++;
+            return r;
+        }
+
+        struct QuotRem
+        {
+            uint64_t quot, rem;
+        };
+
+        // floor(2^(64+k) / d) by long division, requires d > 2^k (quotient fits in 64 bit)
+        constexpr QuotRem divPow2(unsigned k, uint64_t d)
+        {
+            uint64_t q = 0, r = 0;
+            for (int bit = 64 + k; bit >= 0; bit--)
+            {
+                bool carry = r >> 63;
+                r          = (r << 1) | (bit == (int)(64 + k) ? 1 : 0);
+                q <<= 1;
+                if (carry || r >= d)
+                {
+                    r -= d;
+                    q |= 1;
+                }
+            }
+            return {q, r};
+        }
+
+        struct Divider
+        {
+            uint64_t magic;
+            unsigned shift;
+            bool add;  // magic needs 65 bits, the 65th bit is handled by an extra add
+            bool pow2; // plain shift
+        };
+
+        constexpr Divider makeDivider(uint64_t d)
+        {
+            unsigned k = floorLog2(d);
+            if ((d & (d - 1)) == 0) return {0, k, false, true};
+
+            QuotRem qr = divPow2(k, d);
+            uint64_t m = qr.quot;
+            bool add   = false;
+
+            if (d - qr.rem >= (uint64_t(1) << k)) // 64 bit reciprocal not precise enough -> use 65 bit reciprocal
+            {
+                uint64_t twiceRem = qr.rem + qr.rem;
+                m += m;
+                if (twiceRem >= d || twiceRem < qr.rem) m += 1;
+                add = true;
+            }
+            return {m + 1, k, add, false};
+        }
+
+        // n / d using the divider D = makeDivider(d)
+        constexpr uint64_t divide(uint64_t n, const Divider& D)
+        {
+            if (D.pow2) return n >> D.shift;
+
+            uint64_t q = mulhi(D.magic, n);
+            if (D.add) return (((n - q) >> 1) + q) >> D.shift;
+            return q >> D.shift;
+        }
+
+        // n / d for a compile time constant d
+        template <uint64_t d>
+        constexpr uint64_t divide(uint64_t n)
+        {
+            static_assert(d != 0, "division by zero");
+            constexpr Divider D = makeDivider(d);
+            return divide(n, D);
+        }
+
+        // floor(n * num / den) without overflow of the intermediate product
+        template <uint64_t num, uint64_t den>
+        constexpr uint64_t scale(uint64_t n)
+        {
+            static_assert(num == 1 || den == 1 || num <= UINT64_MAX / den, "ratio too large");
+
+            return den == 1   ? n * num
+                   : num == 1 ? divide<den>(n)
+                              : divide<den>(n) * num + divide<den>((n - divide<den>(n) * den) * num);
+        }
+
+        template <class To, class Rep, class Period>
+        constexpr To cast(const std::chrono::duration<Rep, Period>& d, std::true_type)
+        {
+            using cf = std::ratio_divide<Period, typename To::period>;
+            return To(static_cast<typename To::rep>(scale<cf::num, cf::den>(d.count())));
+        }
+
+        template <class To, class Rep, class Period>
+        constexpr To cast(const std::chrono::duration<Rep, Period>& d, std::false_type)
+        {
+            return std::chrono::duration_cast<To>(d);
+        }
+    }
+
+    template <class To, class Rep, class Period>
+    constexpr To fast_duration_cast(const std::chrono::duration<Rep, Period>& d)
+    {
+        using useFast = std::integral_constant<bool, std::is_integral<Rep>::value && std::is_unsigned<Rep>::value && sizeof(Rep) <= sizeof(uint64_t) &&
+                                                         std::is_integral<typename To::rep>::value>;
+        return detail::cast<To>(d, useFast{});
+    }
+
+    template <class To, class Clock, class Duration>
+    constexpr std::chrono::time_point<Clock, To> fast_time_point_cast(const std::chrono::time_point<Clock, Duration>& tp)
+    {
+        return std::chrono::time_point<Clock, To>(fast_duration_cast<To>(tp.time_since_epoch()));
+    }
+}
+
+using fast_chrono::fast_duration_cast;
+using fast_chrono::fast_time_point_cast;
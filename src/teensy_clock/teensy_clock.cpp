@@ -10,7 +10,7 @@ void teensy_clock::begin(bool sync)
 std::time_t teensy_clock::to_time_t(const time_point& t)
 {
     using namespace std::chrono;
-    return std::time_t(duration_cast<seconds>(t.time_since_epoch()).count());
+    return std::time_t(fast_duration_cast<seconds>(t.time_since_epoch()).count());
 }
 
 teensy_clock::time_point teensy_clock::from_time_t(std::time_t t)
@@ -4,6 +4,7 @@
 #include <chrono>
 
 #include "cycles64.h"
+#include "fast_duration_cast.h"
 
 struct teensy_clock
 {
@@ -28,7 +29,23 @@ struct teensy_clock
     static std::time_t to_time_t(const time_point& t);                       // returns the time_t value (seconds since 1.1.1970) to be used with standard C-API functions
     static time_point from_time_t(std::time_t t);                            // converts a time_t value to a time_point
 
+    // division free conversions (see fast_duration_cast.h)
+    static constexpr uint64_t toMillis(duration d) { return fast_duration_cast<std::chrono::duration<uint64_t, std::milli>>(d).count(); }
+    static constexpr uint64_t toMicros(duration d) { return fast_duration_cast<std::chrono::duration<uint64_t, std::micro>>(d).count(); }
+    static constexpr uint64_t toNanos(duration d) { return fast_duration_cast<std::chrono::duration<uint64_t, std::nano>>(d).count(); }
+
  private:
     static uint64_t t0;                                                      // offset to adjust time (seconds from 1.1.1970 to now).
 };
-    
\ No newline at end of file
+
+struct teensy_steady_clock                                                   // monotonic clock counting cycles since startup, never adjusted
+{
+    using duration   = teensy_clock::duration;
+    using rep        = duration::rep;
+    using period     = duration::period;
+    using time_point = std::chrono::time_point<teensy_steady_clock, duration>;
+
+    static constexpr bool is_steady = true;
+
+    static time_point now() { return time_point(duration(cycles64::get())); }
+};
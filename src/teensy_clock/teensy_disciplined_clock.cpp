@@ -0,0 +1,132 @@
+#include "teensy_disciplined_clock.h"
+#include "cycles64.h"
+
+teensy_disciplined_clock::time_point teensy_disciplined_clock::now()
+{
+    uint32_t gen;
+    uint64_t t;
+    do
+    {
+        gen = generation;
+        t   = timeAt(params[gen & 1], cycles64::get());
+    } while (gen != generation);                                             // parameters changed while reading -> retry
+
+    return time_point(duration(t));
+}
+
+void teensy_disciplined_clock::begin()
+{
+    cycles64::begin();
+    cycles64::attachSecondTick([](uint64_t cycles) { update(cycles, rtc_get()); });
+}
+
+void teensy_disciplined_clock::update(uint64_t cycles, uint32_t rtcSeconds)
+{
+    const int64_t target = (int64_t)rtcSeconds * F_CPU;                       // where the clock should be at this edge
+
+    uint32_t dSec = rtcSeconds - lastSeconds;
+    uint64_t dCyc = cycles - lastEdge;
+    lastSeconds   = rtcSeconds;
+    lastEdge      = cycles;
+
+    if (!started || dSec == 0 || dSec > 8)                                    // first edge, missed edges or RTC adjusted -> start over
+    {
+        started   = true;
+        locked    = false;
+        freqEst   = 0;
+        lastPhase = 0;
+        setParams(cycles, target, 0);
+        return;
+    }
+
+    int64_t measured = (int64_t)(dCyc / dSec);                                // cycles per RTC second
+    if (freqEst == 0)
+    {
+        freqEst = measured << 8;
+    }
+    else
+    {
+        freqEst += ((measured << 8) - freqEst) / 8;                          // low pass, smoothes ISR latency jitter
+    }
+
+    const Params& p = params[generation & 1];
+    uint64_t now    = timeAt(p, cycles);
+    int64_t phase   = target - (int64_t)now;
+    lastPhase       = -phase;
+
+    if (phase > stepThreshold || phase < -stepThreshold)
+    {
+        locked = false;
+        setParams(cycles, target, 0);
+        return;
+    }
+
+    int64_t slew = phase / 4;                                                 // remove a quarter of the phase error per second
+    if (slew > maxSlew) slew = maxSlew;
+    if (slew < -maxSlew) slew = -maxSlew;
+
+    // rate = (F_CPU + slew) / freqEst, stored as (rate-1) in Q32
+    int64_t num        = ((int64_t)F_CPU << 8) + (slew << 8) - freqEst;
+    int64_t correction = (num << 24) / (freqEst >> 8);
+
+    setParams(cycles, now, correction);                                       // rebase at the current edge -> no jump
+    locked = true;
+}
+
+int32_t teensy_disciplined_clock::frequencyError()
+{
+    if (freqEst == 0) return 0;
+    return (int32_t)((freqEst - ((int64_t)F_CPU << 8)) * 1'000'000'000 / ((int64_t)F_CPU << 8));
+}
+
+int32_t teensy_disciplined_clock::phaseError()
+{
+    return (int32_t)lastPhase;
+}
+
+bool teensy_disciplined_clock::isLocked()
+{
+    return locked;
+}
+
+std::time_t teensy_disciplined_clock::to_time_t(const time_point& t)
+{
+    using namespace std::chrono;
+    return std::time_t(fast_duration_cast<seconds>(t.time_since_epoch()).count());
+}
+
+teensy_disciplined_clock::time_point teensy_disciplined_clock::from_time_t(std::time_t t)
+{
+    using namespace std::chrono;
+    typedef std::chrono::time_point<teensy_disciplined_clock, seconds> from;
+    return time_point_cast<duration>(from(seconds(t)));
+}
+
+//----------------------------------------------------------------------------------
+
+uint64_t teensy_disciplined_clock::timeAt(const Params& p, uint64_t cycles)
+{
+    int64_t dc = (int64_t)(cycles - p.baseCycles);
+    return p.baseTime + dc + ((dc * p.correction) >> 32);
+}
+
+// writes the inactive parameter set and activates it afterwards
+void teensy_disciplined_clock::setParams(uint64_t baseCycles, uint64_t baseTime, int64_t correction)
+{
+    uint32_t gen = generation;
+    Params& p    = params[(gen + 1) & 1];
+    p.baseCycles = baseCycles;
+    p.baseTime   = baseTime;
+    p.correction = correction;
+    asm volatile("" ::: "memory");
+    generation = gen + 1;
+}
+
+teensy_disciplined_clock::Params teensy_disciplined_clock::params[2] = {};
+volatile uint32_t teensy_disciplined_clock::generation                = 0;
+int64_t teensy_disciplined_clock::freqEst                             = 0;
+int64_t teensy_disciplined_clock::lastPhase                           = 0;
+uint64_t teensy_disciplined_clock::lastEdge                           = 0;
+uint32_t teensy_disciplined_clock::lastSeconds                        = 0;
+bool teensy_disciplined_clock::started                                = false;
+bool teensy_disciplined_clock::locked                                 = false;
@@ -0,0 +1,65 @@
+#pragma once
+/************************************************************************************
+ * Wall clock which is continuously disciplined to the RTC.
+ *
+ * Other than teensy_clock, which jumps at each syncToRTC(), this clock measures the
+ * cycle counter frequency against the RTC second edges and smoothly slews its rate
+ * to follow the RTC. Time advances monotonically and without jumps. Only if the RTC is
+ * adjusted by more than stepThreshold the clock steps.
+ *
+ * The rate is applied as a fixed point correction (Q32) to the cycle counter:
+ *   time = baseTime + dc + dc * correction / 2^32     with dc = cycles - baseCycles
+ * The parameters are double buffered, now() neither locks nor disables interrupts.
+ *
+ * begin():           starts cycles64 and the discipline loop (uses the 1Hz SNVS interrupt)
+ * update(c, sec):    feeds a RTC second edge (called automatically, public for simulation)
+ * frequencyError():  estimated frequency error of the cycle counter (ppb)
+ * phaseError():      clock - RTC at the last second edge (cycles)
+ ************************************************************************************/
+
+#include "teensy_clock.h"
+
+struct teensy_disciplined_clock
+{
+    using duration   = teensy_clock::duration;
+    using rep        = duration::rep;
+    using period     = duration::period;
+    using time_point = std::chrono::time_point<teensy_disciplined_clock, duration>;
+
+    static constexpr bool is_steady = false;                                 // steps if the RTC is adjusted by more than stepThreshold
+
+    static constexpr int64_t stepThreshold = F_CPU / 100;                    // 10ms, larger phase errors are not slewed but stepped
+    static constexpr int64_t maxSlew       = F_CPU / 2000;                   // max phase correction per second (500ppm)
+
+    static time_point now();
+    static void begin();
+    static void update(uint64_t cycles, uint32_t rtcSeconds);
+
+    static int32_t frequencyError();
+    static int32_t phaseError();
+    static bool isLocked();                                                  // true after the first slewed update
+
+    //Map to C API
+    static std::time_t to_time_t(const time_point& t);
+    static time_point from_time_t(std::time_t t);
+
+ private:
+    struct Params
+    {
+        uint64_t baseCycles;
+        uint64_t baseTime;
+        int64_t correction;                                                  // (rate - 1) * 2^32
+    };
+
+    static uint64_t timeAt(const Params& p, uint64_t cycles);
+    static void setParams(uint64_t baseCycles, uint64_t baseTime, int64_t correction);
+
+    static Params params[2];
+    static volatile uint32_t generation;                                     // params[generation & 1] is active
+
+    static int64_t freqEst;                                                  // estimated cycles per RTC second (Q8)
+    static int64_t lastPhase;
+    static uint64_t lastEdge;
+    static uint32_t lastSeconds;
+    static bool started, locked;
+};